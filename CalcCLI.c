@@ -336,11 +336,13 @@ char* readLineRaw() {
             return NULL;
         }
         if(character == '\n') return out;
-        if(charPos == outLen) {
+        //Keep room for the null terminator
+        if(charPos + 1 == outLen) {
             out = realloc(out, (outLen += 10));
             if(out == NULL) { error(mallocError);return NULL; }
         }
         out[charPos++] = character;
+        out[charPos] = '\0';
     }
     return out;
 }
@@ -870,18 +872,18 @@ void runLine(char* input) {
                 struct ArbNumber n = *out.numArb;
                 if(n.r.mantissa != NULL) {
                     printf("r (len:%d, accu:%d): %c{", n.r.len, n.r.accu, n.r.sign ? '-' : '+');
-                    for(int i = 0;i < n.r.len;i++) printf("%d,", n.r.mantissa[i]);
+                    for(int i = 0;i < n.r.len;i++) printf("%u,", n.r.mantissa[i]);
                     printf("}exp%d\n", n.r.exp);
                 }
                 else printf("r: NULL");
                 if(n.i.mantissa != NULL) {
                     printf("i (len:%d, accu:%d): %c{", n.i.len, n.i.accu, n.i.sign ? '-' : '+');
-                    for(int i = 0;i < n.i.len;i++) printf("%d,", n.i.mantissa[i]);
+                    for(int i = 0;i < n.i.len;i++) printf("%u,", n.i.mantissa[i]);
                     printf("}exp%d\n", n.i.exp);
                 }
                 else printf("i: NULL");
+                //The history takes ownership of out
                 appendToHistory(out, 10, true);
-                freeValue(out);
             }
             if(startsWith(input, "-dperf")) {
                 //Syntax: -dperf{count} {type} {exp}
@@ -932,6 +934,10 @@ void runLine(char* input) {
                     strcpy(in, runType + 5);
                     inputClean(in);
                     Tree tr = generateTree(in, NULL, globalLocalVariables, 0);
+                    arbConstantHits = 0;
+                    arbConstantComputes = 0;
+                    arbAllocCount = 0;
+                    arbArenaGrowCount = 0;
                     clock_t t = clock();
                     for(int i = 0;i < runCount;i++) {
                         Value val = computeTree(tr, NULL, 0, globalLocalVariableValues);
@@ -939,9 +945,42 @@ void runLine(char* input) {
                     }
                     t = clock() - t;
                     printPerformance("Calculation", t, runCount);
+                    if(useArb) {
+                        printf("Constant cache: %d hits, %d computed\n", arbConstantHits, arbConstantComputes);
+                        printf("Arb allocations: %lld (%.1f per run), arena grew %lld times\n", arbAllocCount, (double)arbAllocCount / runCount, arbArenaGrowCount);
+                    }
                     freeTree(tr);
                     return;
                 }
+                else if(startsWith(runType, "mult")) {
+                    //Find the length where each multiplication algorithm beats the previous one
+                    void (*algorithms[])(const uint32_t*, int, const uint32_t*, int, uint32_t*) = { &digitMultSchool,&digitMultKaratsuba,&digitMultToom3,&digitMultNTT };
+                    const char* names[] = { "Schoolbook","Karatsuba","Toom-3","NTT" };
+                    const int thresholds[] = { karatsubaThreshold,toomThreshold,nttThreshold };
+                    for(int alg = 0;alg < 3;alg++) {
+                        int crossover = 0;
+                        for(int len = 8;len < 100000 && crossover == 0;len += len / 4) {
+                            uint32_t* a = malloc(len * 4 * sizeof(uint32_t));
+                            uint32_t* b = a + len;
+                            uint32_t* out = a + len * 2;
+                            for(int j = 0;j < len * 2;j++) a[j] = (uint32_t)rand() << 16 ^ rand();
+                            int runs = runCount * 10000 / len + 1;
+                            clock_t times[2];
+                            for(int j = 0;j < 2;j++) {
+                                times[j] = clock();
+                                for(int k = 0;k < runs;k++) algorithms[alg + j](a, len, b, len, out);
+                                times[j] = clock() - times[j];
+                            }
+                            if(times[1] < times[0]) crossover = len;
+                            free(a);
+                        }
+                        printf("%s is faster than %s ", names[alg + 1], names[alg]);
+                        if(crossover == 0) printf("below 100000 digits");
+                        else printf("at %d digits", crossover);
+                        printf(" (threshold is %d)\n", thresholds[alg]);
+                    }
+                    return;
+                }
                 else if(startsWith(runType, "startup")) {
                     cleanup();
                     clock_t t = clock();
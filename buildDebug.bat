@@ -1 +1 @@
-gcc -g CalcCLI.c -lm -o calc.exe src/arb.c src/command.c src/compute.c src/functions.c src/general.c src/help.c src/highlight.c src/misc.c src/parser.c src/print.c src/units.c
\ No newline at end of file
+gcc -g CalcCLI.c -lm -pthread -o calc.exe src/arb.c src/command.c src/compute.c src/functions.c src/general.c src/help.c src/highlight.c src/misc.c src/parser.c src/print.c src/units.c
\ No newline at end of file
@@ -3,14 +3,50 @@
 #include "arb.h"
 #include <math.h>
 #include <string.h>
+#include <stdint.h>
+#if defined __EMSCRIPTEN__ && !defined __EMSCRIPTEN_PTHREADS__
+#define ARB_NO_THREADS
+#endif
+#ifndef ARB_NO_THREADS
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#endif
+#ifndef _WIN32
+#include <unistd.h>
+#endif
 int globalAccuracy=0;
 bool useArb=false;
+bool useBall=false;
+bool useDD=false;
+bool useDec=false;
 int digitAccuracy=0;
+//Constants kept at the highest accuracy computed so far
+Arb arbConstants[arbconst_count];
+int arbConstantHits=0;
+int arbConstantComputes=0;
+int factorialTreeLimit=100000;
+//Cached powers of the radix used by arbToString
+Arb radixPowers[32];
+int radixPowerCount=0;
+int radixPowerBase=0;
+//Bump arena for temporary digits, released in stack order with arbArenaMark and arbArenaRelease
+//Each thread has its own arena
+_Thread_local uint32_t* arenaBlocks[32];
+_Thread_local int arenaSizes[32];
+_Thread_local int arenaBlockCount=0;
+_Thread_local int arenaUsed=0;
+_Thread_local long long arbAllocCount=0;
+_Thread_local long long arbFreeCount=0;
+_Thread_local long long arbArenaGrowCount=0;
 int getArbDigitCount(int base) {
     if(base == 10) return digitAccuracy;
     return (int)(digitAccuracy * log(10) / log(base)) + 1;
 }
-Arb arbCTR(unsigned char* mant, short len, short exp, char sign, short accu) {
+int getArbLimbCount(double digits) {
+    return (int)ceil((digits + 5) * log(10) / log(4294967296.0)) + 1;
+}
+Arb arbCTR(uint32_t* mant, int len, int exp, char sign, int accu) {
     Arb out;
     out.mantissa = mant;
     out.len = len;
@@ -19,31 +55,99 @@ Arb arbCTR(unsigned char* mant, short len, short exp, char sign, short accu) {
     out.accu = accu;
     return out;
 }
+uint32_t* arbAlloc(int len) {
+    arbAllocCount++;
+    return calloc(len, sizeof(uint32_t));
+}
+uint32_t* arbScratch(int len) {
+    //Keep the arena aligned for uint64_t scratch
+    len += len & 1;
+    if(arenaBlockCount == 0 || arenaUsed + len > arenaSizes[arenaBlockCount - 1]) {
+        int size = arenaBlockCount == 0 ? 65536 : arenaSizes[arenaBlockCount - 1] * 2;
+        while(size < len) size *= 2;
+        arenaBlocks[arenaBlockCount] = malloc(size * sizeof(uint32_t));
+        arenaSizes[arenaBlockCount] = size;
+        arenaBlockCount++;
+        arenaUsed = 0;
+        arbArenaGrowCount++;
+    }
+    uint32_t* out = arenaBlocks[arenaBlockCount - 1] + arenaUsed;
+    arenaUsed += len;
+    memset(out, 0, len * sizeof(uint32_t));
+    return out;
+}
+long long arbArenaMark() {
+    return (long long)arenaBlockCount << 32 | arenaUsed;
+}
+void arbArenaRelease(long long mark) {
+    //Blocks added since the mark stay allocated until arbArenaReset
+    if(mark >> 32 == arenaBlockCount) arenaUsed = mark & 0xFFFFFFFF;
+    else arenaUsed = 0;
+}
+void arbArenaReset() {
+    if(arenaBlockCount == 0) return;
+    //Keep the largest block for the next evaluation
+    for(int i = 0;i < arenaBlockCount - 1;i++) free(arenaBlocks[i]);
+    arenaBlocks[0] = arenaBlocks[arenaBlockCount - 1];
+    arenaSizes[0] = arenaSizes[arenaBlockCount - 1];
+    arenaBlockCount = 1;
+    arenaUsed = 0;
+}
+//Frees every block of this thread's arena
+void arbArenaFree() {
+    for(int i = 0;i < arenaBlockCount;i++) free(arenaBlocks[i]);
+    arenaBlockCount = 0;
+    arenaUsed = 0;
+}
+Arb arbBuffer(int accu) {
+    return arbCTR(arbAlloc(accu + 2), 1, 0, 0, accu);
+}
+Arb arbScratchBuffer(int accu) {
+    return arbCTR(arbScratch(accu + 2), 1, 0, 0, accu);
+}
 Arb copyArb(Arb arb) {
     Arb out = arb;
-    out.mantissa = malloc(out.len);
-    memcpy(out.mantissa, arb.mantissa, out.len);
+    if(arb.mantissa == NULL) return out;
+    out.mantissa = arbAlloc(out.len);
+    memcpy(out.mantissa, arb.mantissa, out.len * sizeof(uint32_t));
+    return out;
+}
+Arb arbWithAccu(Arb one, int accu) {
+    Arb out = arbCTR(arbAlloc(one.len + 1), one.len, one.exp, one.sign, accu);
+    memcpy(out.mantissa, one.mantissa, one.len * sizeof(uint32_t));
+    trimZeroes(&out);
     return out;
 }
+bool arbIsZero(Arb one) {
+    return one.mantissa == NULL || (one.len == 1 && one.mantissa[0] == 0);
+}
 void freeArb(Arb arb) {
-    if(arb.mantissa != NULL) free(arb.mantissa);
-    return;
+    if(arb.mantissa == NULL) return;
+    free(arb.mantissa);
+    arbFreeCount++;
 }
-void trimZeroes(Arb* arb) {
+//trimZeroes for digits of any base, digits of at least half round up and a digit of max carries
+void trimLimbs(Arb* arb, uint32_t half, uint32_t max) {
     int leftCount = 0;
     int i = -1;
-    while(arb->mantissa[++i] == 0 && i != arb->len) leftCount++;
+    while(++i != arb->len && arb->mantissa[i] == 0) leftCount++;
     if(leftCount != 0) {
         if(leftCount == arb->len) leftCount--;
         arb->exp -= leftCount;
         arb->len -= leftCount;
-        memmove(arb->mantissa, arb->mantissa + leftCount, arb->len);
+        memmove(arb->mantissa, arb->mantissa + leftCount, arb->len * sizeof(uint32_t));
     }
     while(arb->mantissa[arb->len - 1] == 0 && arb->len != 1) arb->len--;
+    //Zero is always positive with an exponent of zero
+    if(arb->len == 1 && arb->mantissa[0] == 0) {
+        arb->exp = 0;
+        arb->sign = 0;
+        return;
+    }
     if(arb->len > arb->accu) {
         arb->len = arb->accu;
-        if(arb->mantissa[arb->len] > 128) {
-            while(arb->mantissa[arb->len - 1] == 255) arb->len--;
+        if(arb->mantissa[arb->len] >= half) {
+            while(arb->len != 0 && arb->mantissa[arb->len - 1] == max) arb->len--;
             if(arb->len == 0) {
                 arb->len = 1;
                 arb->mantissa[0] = 1;
@@ -51,14 +155,29 @@ void trimZeroes(Arb* arb) {
             }
             else arb->mantissa[arb->len - 1]++;
         }
+        while(arb->mantissa[arb->len - 1] == 0 && arb->len != 1) arb->len--;
+    }
+    //Numbers too small to represent become zero
+    if(arb->exp < -ARB_MAX_EXP) {
+        arb->len = 1;
+        arb->mantissa[0] = 0;
+        arb->exp = 0;
+        arb->sign = 0;
     }
+    if(arb->exp > ARB_MAX_EXP) {
+        error("Overflow in arbitrary-precision number");
+        arb->exp = ARB_MAX_EXP;
+    }
+}
+void trimZeroes(Arb* arb) {
+    trimLimbs(arb, 0x80000000, 0xFFFFFFFF);
 }
 void arbRightShift(Arb* arb, int count) {
     arb->exp += count;
     arb->len += count;
     if(arb->len > arb->accu) arb->len = arb->accu;
-    memmove(arb->mantissa + count, arb->mantissa, arb->len - count);
-    memset(arb->mantissa, 0, count);
+    memmove(arb->mantissa + count, arb->mantissa, (arb->len - count) * sizeof(uint32_t));
+    memset(arb->mantissa, 0, count * sizeof(uint32_t));
 }
 int arbCmp(Arb one, Arb two) {
     //Note: this function ignores the sign of a number
@@ -70,213 +189,618 @@ int arbCmp(Arb one, Arb two) {
     if(one.exp > two.exp) return 1;
     if(one.exp < two.exp) return -1;
     int len = one.len > two.len ? two.len : one.len;
-    int cmp = memcmp(one.mantissa, two.mantissa, len);
-    if(cmp != 0) return cmp;
-    if(one.len == two.len) return 0;
-    if(one.len > two.len) {
-        int i = len;
-        while(++i != one.len) if(one.mantissa[i] != 0) return 1;
+    int i;
+    for(i = 0;i < len;i++) if(one.mantissa[i] != two.mantissa[i]) return one.mantissa[i] > two.mantissa[i] ? 1 : -1;
+    for(i = len;i < one.len;i++) if(one.mantissa[i] != 0) return 1;
+    for(i = len;i < two.len;i++) if(two.mantissa[i] != 0) return -1;
+    return 0;
+}
+#pragma region Thread Pool
+/*
+    Large products and radix conversions split into independent halves, which are run on a work-stealing pool.
+    Each thread has a deque of tasks: it pushes and pops its own tasks at the bottom, while idle threads steal from the top.
+    A thread waiting for a task to finish runs other tasks in the meantime, so nested splits never block the pool.
+    Each thread has its own scratch arena, and the caches are only filled by the thread that started the operation.
+*/
+int arbThreadCount = 0;
+int arbParallelThreshold = 1500;
+int arbCores = 0;
+int arbCoreCount() {
+    if(arbCores != 0) return arbCores;
+#ifdef _SC_NPROCESSORS_ONLN
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+#else
+    char* env = getenv("NUMBER_OF_PROCESSORS");
+    long count = env == NULL ? 1 : atol(env);
+#endif
+    arbCores = count < 1 ? 1 : count > ARB_MAX_THREADS ? ARB_MAX_THREADS : count;
+    return arbCores;
+}
+int arbActiveThreads() {
+#ifdef ARB_NO_THREADS
+    return 1;
+#endif
+    return arbThreadCount == 0 ? arbCoreCount() : arbThreadCount;
+}
+bool arbUseThreads(long long len) {
+    return len >= arbParallelThreshold && arbActiveThreads() > 1;
+}
+#ifndef ARB_NO_THREADS
+#define ARB_DEQUE_SIZE 1024
+typedef struct ArbTaskStruct {
+    void (*run)(void* arg);
+    void* arg;
+    atomic_int done;
+} ArbTask;
+typedef struct ArbWorkerStruct {
+    pthread_mutex_t lock;
+    ArbTask* tasks[ARB_DEQUE_SIZE];
+    //Tasks are in [top,bottom), modulo ARB_DEQUE_SIZE
+    int top;
+    int bottom;
+    pthread_t thread;
+} ArbWorker;
+ArbWorker arbWorkers[ARB_MAX_THREADS];
+//Number of threads in the pool including the main thread, 0 when it is not running
+int arbPoolSize = 0;
+_Thread_local int arbWorkerIndex = 0;
+atomic_int arbPendingTasks;
+bool arbPoolStopping = false;
+pthread_mutex_t arbPoolLock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t arbPoolWake = PTHREAD_COND_INITIALIZER;
+ArbTask* arbPopTask(ArbWorker* worker, bool steal) {
+    ArbTask* out = NULL;
+    pthread_mutex_lock(&worker->lock);
+    if(worker->bottom != worker->top) {
+        if(steal) out = worker->tasks[worker->top++ % ARB_DEQUE_SIZE];
+        else out = worker->tasks[--worker->bottom % ARB_DEQUE_SIZE];
+        atomic_fetch_sub(&arbPendingTasks, 1);
+    }
+    pthread_mutex_unlock(&worker->lock);
+    return out;
+}
+//Pops a task from this thread's deque, or steals one from another thread
+ArbTask* arbFindTask() {
+    ArbTask* task = arbPopTask(arbWorkers + arbWorkerIndex, false);
+    for(int i = 1;task == NULL && i < arbPoolSize;i++) task = arbPopTask(arbWorkers + (arbWorkerIndex + i) % arbPoolSize, true);
+    return task;
+}
+void arbRunTask(ArbTask* task) {
+    task->run(task->arg);
+    atomic_store(&task->done, 1);
+}
+void* arbWorkerMain(void* arg) {
+    arbWorkerIndex = (intptr_t)arg;
+    while(true) {
+        ArbTask* task = arbFindTask();
+        if(task != NULL) {
+            arbRunTask(task);
+            continue;
+        }
+        pthread_mutex_lock(&arbPoolLock);
+        while(atomic_load(&arbPendingTasks) == 0 && !arbPoolStopping) pthread_cond_wait(&arbPoolWake, &arbPoolLock);
+        bool stop = arbPoolStopping;
+        pthread_mutex_unlock(&arbPoolLock);
+        if(stop) break;
+    }
+    arbArenaFree();
+    return NULL;
+}
+//Stops the pool, where the workers below started are running
+void arbPoolShutdown(int started) {
+    pthread_mutex_lock(&arbPoolLock);
+    arbPoolStopping = true;
+    pthread_cond_broadcast(&arbPoolWake);
+    pthread_mutex_unlock(&arbPoolLock);
+    for(int i = 1;i < started;i++) pthread_join(arbWorkers[i].thread, NULL);
+    for(int i = 0;i < arbPoolSize;i++) pthread_mutex_destroy(&arbWorkers[i].lock);
+    arbPoolSize = 0;
+}
+void arbPoolStart() {
+    int threads = arbActiveThreads();
+    arbPoolStopping = false;
+    for(int i = 0;i < threads;i++) {
+        pthread_mutex_init(&arbWorkers[i].lock, NULL);
+        arbWorkers[i].top = 0;
+        arbWorkers[i].bottom = 0;
     }
-    if(two.len > one.len) {
-        int i = len - 1;
-        while(++i != two.len) if(two.mantissa[i] != 0) return -1;
+    arbPoolSize = threads;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, 8 << 20);
+    for(int i = 1;i < threads;i++) if(pthread_create(&arbWorkers[i].thread, &attr, &arbWorkerMain, (void*)(intptr_t)i) != 0) {
+        //Fall back to one thread if the pool cannot be created
+        arbPoolShutdown(i);
+        arbThreadCount = 1;
+        break;
     }
-    return 0;
+    pthread_attr_destroy(&attr);
+}
+void arbPoolStop() {
+    if(arbPoolSize != 0) arbPoolShutdown(arbPoolSize);
+}
+//Queues run(arg) on the pool, or runs it immediately if the pool is disabled or full
+void arbTaskSpawn(ArbTask* task, void (*run)(void* arg), void* arg) {
+    task->run = run;
+    task->arg = arg;
+    atomic_store(&task->done, 0);
+    if(arbPoolSize == 0 && arbActiveThreads() > 1) arbPoolStart();
+    if(arbPoolSize > 1) {
+        ArbWorker* worker = arbWorkers + arbWorkerIndex;
+        pthread_mutex_lock(&worker->lock);
+        bool queued = worker->bottom - worker->top < ARB_DEQUE_SIZE;
+        if(queued) {
+            worker->tasks[worker->bottom++ % ARB_DEQUE_SIZE] = task;
+            atomic_fetch_add(&arbPendingTasks, 1);
+        }
+        pthread_mutex_unlock(&worker->lock);
+        if(queued) {
+            pthread_mutex_lock(&arbPoolLock);
+            pthread_cond_signal(&arbPoolWake);
+            pthread_mutex_unlock(&arbPoolLock);
+            return;
+        }
+    }
+    arbRunTask(task);
+}
+//Waits for a spawned task, running other tasks until it is done
+void arbTaskJoin(ArbTask* task) {
+    while(!atomic_load(&task->done)) {
+        ArbTask* other = arbFindTask();
+        if(other != NULL) arbRunTask(other);
+        else sched_yield();
+    }
+}
+#else
+typedef struct ArbTaskStruct {
+    int done;
+} ArbTask;
+void arbPoolStop() {}
+void arbTaskSpawn(ArbTask* task, void (*run)(void* arg), void* arg) {
+    run(arg);
+    task->done = 1;
+}
+void arbTaskJoin(ArbTask* task) {}
+#endif
+void arbSetThreadCount(int count) {
+    arbPoolStop();
+    arbThreadCount = count < 0 ? 0 : count > ARB_MAX_THREADS ? ARB_MAX_THREADS : count;
+}
+//Calls run on count arguments that are size bytes apart, spread over the pool if parallel is true
+void arbRunAll(void (*run)(void* arg), void* args, int size, int count, bool parallel) {
+    if(!parallel) {
+        for(int i = 0;i < count;i++) run((char*)args + i * size);
+        return;
+    }
+    ArbTask tasks[count];
+    for(int i = 1;i < count;i++) arbTaskSpawn(tasks + i, run, (char*)args + i * size);
+    run(args);
+    for(int i = count - 1;i > 0;i--) arbTaskJoin(tasks + i);
+}
+//Runs body over [0,count) in chunks of at least grain, spread over the pool
+typedef struct ArbRangeStruct {
+    void (*body)(void* ctx, int start, int end);
+    void* ctx;
+    int start;
+    int end;
+} ArbRange;
+void arbRunRange(void* arg) {
+    ArbRange* range = arg;
+    range->body(range->ctx, range->start, range->end);
+}
+void arbParallelFor(int count, int grain, void (*body)(void* ctx, int start, int end), void* ctx) {
+    int chunks = arbActiveThreads() * 4;
+    if(chunks > count / grain) chunks = count / grain;
+    if(chunks <= 1) {
+        body(ctx, 0, count);
+        return;
+    }
+    ArbRange ranges[chunks];
+    for(int i = 0;i < chunks;i++) {
+        ranges[i].body = body;
+        ranges[i].ctx = ctx;
+        ranges[i].start = (long long)count * i / chunks;
+        ranges[i].end = (long long)count * (i + 1) / chunks;
+    }
+    arbRunAll(&arbRunRange, ranges, sizeof(ArbRange), chunks, true);
 }
+#pragma endregion
 #pragma region Arbitrary Precision Conversion
+//Number of digits in base that fit in one 32 bit digit
+int radixBlockDigits(int base) {
+    int digits = 0;
+    uint64_t power = base;
+    while(power <= 0xFFFFFFFF) {
+        power *= base;
+        digits++;
+    }
+    return digits;
+}
+//Returns base^(radixBlockDigits(base)*2^level) from the cache, the result must not be freed
+Arb getRadixPower(int base, int level) {
+    if(radixPowerBase != base) {
+        for(int i = 0;i < radixPowerCount;i++) freeArb(radixPowers[i]);
+        radixPowerCount = 0;
+        radixPowerBase = base;
+    }
+    while(radixPowerCount <= level) {
+        if(radixPowerCount == 0) {
+            uint64_t power = 1;
+            for(int i = radixBlockDigits(base);i > 0;i--) power *= base;
+            radixPowers[0] = intToArb(power, 1);
+        }
+        else {
+            //Squares are exact
+            Arb prev = radixPowers[radixPowerCount - 1];
+            prev.accu = prev.exp * 2 + 2;
+            radixPowers[radixPowerCount] = arb_mult(prev, prev);
+        }
+        radixPowerCount++;
+    }
+    return radixPowers[level];
+}
+typedef struct BlockConversionStruct {
+    const uint32_t* blocks;
+    int count;
+    int base;
+    Arb out;
+} BlockConversion;
+void arbRunBlockConversion(void* arg);
+//Returns the integer with count digits in base^radixBlockDigits(base), using a balanced product tree
+Arb arbFromBlocks(const uint32_t* blocks, int count, int base) {
+    //Small numbers are built one block at a time
+    if(count <= 16) {
+        uint32_t blockBase = getRadixPower(base, 0).mantissa[0];
+        Arb out = arbCTR(arbAlloc(count + 1), count, count - 1, 0, count + 2);
+        for(int i = 0;i < count;i++) {
+            uint64_t carry = blocks[i];
+            for(int j = count - 1;j >= 0;j--) {
+                uint64_t cur = (uint64_t)out.mantissa[j] * blockBase + carry;
+                out.mantissa[j] = cur;
+                carry = cur >> 32;
+            }
+        }
+        trimZeroes(&out);
+        return out;
+    }
+    //high*base^(blockDigits*2^level) + low, where low has 2^level blocks
+    int level = 0;
+    while((2 << level) < count) level++;
+    int lowCount = 1 << level;
+    //The powers are cached before the halves are built, which may be in parallel
+    Arb power = getRadixPower(base, level);
+    BlockConversion halves[2] = {
+        { blocks,count - lowCount,base },
+        { blocks + count - lowCount,lowCount,base },
+    };
+    arbRunAll(&arbRunBlockConversion, halves, sizeof(BlockConversion), 2, arbUseThreads(count));
+    Arb high = halves[0].out, low = halves[1].out;
+    high.accu = count + 2;
+    Arb product = arb_mult(high, power);
+    Arb out = arb_add(product, low);
+    freeArb(high);
+    freeArb(low);
+    freeArb(product);
+    return out;
+}
+void arbRunBlockConversion(void* arg) {
+    BlockConversion* conversion = arg;
+    conversion->out = arbFromBlocks(conversion->blocks, conversion->count, conversion->base);
+}
+//Returns integer*base^scale rounded to accu digits, with one reciprocal for negative powers, integer is freed
+Arb arbScaleByPower(Arb integer, int base, int scale, int accu) {
+    int workAccu = accu + 2;
+    Arb out;
+    if(scale == 0) out = integer;
+    else {
+        Arb baseArb = intToArb(base, workAccu);
+        Arb scaleArb = intToArb(scale < 0 ? -scale : scale, workAccu);
+        Arb factor = arb_pow(baseArb, scaleArb);
+        integer.accu = workAccu;
+        out = scale < 0 ? arb_divide(integer, factor) : arb_mult(integer, factor);
+        freeArb(baseArb);
+        freeArb(scaleArb);
+        freeArb(factor);
+        freeArb(integer);
+    }
+    out.accu = accu;
+    trimZeroes(&out);
+    return out;
+}
 Arb parseArb(char* string, int base, int accu) {
     int strLen = strlen(string);
-    int digits[strlen(string) + 1];
+    unsigned char digits[strLen + 1];
+    //Exponent of the first significant digit
     int power = -1;
-    int maxDigits = (accu + 2) * log(256) / log(base);
+    int maxDigits = (accu + 2) * 32 * log(2) / log(base);
     bool hasDecimal = false;
     int digitIndex = 0;
     int stringIndex = 0;
-    //Read digits to array
-    while(digitIndex != maxDigits) {
-        char ch = string[stringIndex++];
+    //Read digits to array, 'e' starts the exponent when it cannot be a digit
+    for(;stringIndex < strLen;stringIndex++) {
+        char ch = string[stringIndex];
         if(ch == '.') {
             hasDecimal = true;
             continue;
         }
-        if(ch == '\0') break;
+        if(ch == 'e' && base <= 14) break;
         if(!hasDecimal) power++;
         if(ch == '0' && digitIndex == 0) {
             power--;
             continue;
         }
+        if(digitIndex == maxDigits) continue;
         if(ch <= '9') digits[digitIndex] = ch - '0';
         else if(ch <= 'Z') digits[digitIndex] = ch - 'A' + 10;
         else if(ch <= 'z') digits[digitIndex] = ch - 'a' + 10;
         digitIndex++;
     }
-    unsigned char* baseMant = calloc(1, 1);
-    baseMant[0] = base;
-    //Set base numbers
-    Arb baseArb = arbCTR(baseMant, 1, 0, 0, accu + 10);
-    Arb baseInv = arb_recip(baseArb);
-    //Set out
-    Arb out = arbCTR(calloc(1, 1), 1, 0, 0, accu);
-    //Set current base
-    Arb curBase = arbCTR(calloc(1, 1), 1, 0, 0, accu);
-    curBase.mantissa[0] = 1;
-    //Integer digits
-    int i;
-    for(i = power;i >= 0;i--) {
-        if(i < maxDigits) {
-            Arb val = multByInt(curBase, digits[i]);
-            Arb newOut = arb_add(out, val);
-            freeArb(val);
-            freeArb(out);
-            out = newOut;
-        }
-        if(i != 0) {
-            Arb newCurBase = multByInt(curBase, base);
-            freeArb(curBase);
-            curBase = newCurBase;
-        }
-    }
-    //Fractional digits
-    freeArb(curBase);
-    curBase = copyArb(baseInv);
-    for(i = power + 1;i < digitIndex;i++) {
-        if(i < maxDigits && i >= 0) {
-            Arb val = multByInt(curBase, digits[i]);
-            Arb newOut = arb_add(out, val);
-            freeArb(val);
-            freeArb(out);
-            out = newOut;
-        }
-        if(i + 1 != maxDigits && i + 1 != digitIndex) {
-            Arb newCurBase = arb_mult(curBase, baseInv);
-            freeArb(curBase);
-            curBase = newCurBase;
-            if(-curBase.exp > accu + 1) break;
+    if(digitIndex == 0) return intToArb(0, accu);
+    if(stringIndex < strLen) {
+        bool negative = string[stringIndex + 1] == '-';
+        long long exponent = 0;
+        //Anything past this is outside of the exponent range in any base
+        for(int i = stringIndex + 1 + negative;i < strLen && exponent <= ARB_MAX_EXP * 32LL;i++) exponent = exponent * base + string[i] - '0';
+        if(exponent > ARB_MAX_EXP * 32LL) {
+            if(negative) return intToArb(0, accu);
+            error("Overflow in arbitrary-precision number");
+            return intToArb(0, accu);
         }
+        power += negative ? -exponent : exponent;
     }
-    //Free values and return
-    freeArb(baseArb);
-    freeArb(baseInv);
-    freeArb(curBase);
-    out.accu = accu;
-    trimZeroes(&out);
-    return out;
+    //Check the range before scaling, so huge exponents fail once and tiny ones become zero
+    double bits = (double)power * log2(base);
+    if(bits < -ARB_MAX_EXP * 32.0) return intToArb(0, accu);
+    if(bits > ARB_MAX_EXP * 32.0) {
+        error("Overflow in arbitrary-precision number");
+        return intToArb(0, accu);
+    }
+    //Group the digits into blocks that fit in 32 bits, padding the front with zeros
+    int blockDigits = radixBlockDigits(base);
+    int blockCount = (digitIndex + blockDigits - 1) / blockDigits;
+    int pad = blockCount * blockDigits - digitIndex;
+    long long mark = arbArenaMark();
+    uint32_t* blocks = arbScratch(blockCount);
+    for(int i = 0;i < digitIndex;i++) {
+        int pos = i + pad;
+        blocks[pos / blockDigits] = blocks[pos / blockDigits] * base + digits[i];
+    }
+    Arb integer = arbFromBlocks(blocks, blockCount, base);
+    arbArenaRelease(mark);
+    return arbScaleByPower(integer, base, power - digitIndex + 1, accu);
 }
-Arb doubleToArb(double val, int accu) {
-    Arb out = arbCTR(calloc(10, 1), 1, 0, val < 0 ? 1 : 0, accu);
+void doubleToArb_into(Arb* dst, double val) {
+    dst->len = 1;
+    dst->mantissa[0] = 0;
+    dst->exp = 0;
+    dst->sign = val < 0 ? 1 : 0;
     if(val < 0) val = -val;
-    while(val > 256) {
-        val /= 256;
-        out.exp++;
-    }
-    while(out.len < 10) {
-        if(val == 0) break;
-        out.len++;
-        out.mantissa[out.len - 1] = floor(val);
+    if(val == 0 || isnan(val) || isinf(val)) return;
+    //Normalize val to [1,2^32)
+    int exp2;
+    frexp(val, &exp2);
+    dst->exp = (exp2 - 1) >> 5;
+    val = ldexp(val, -32 * dst->exp);
+    //53 bits of mantissa fit in three digits
+    dst->len = 0;
+    while(dst->len < 3 && val != 0) {
+        dst->mantissa[dst->len++] = floor(val);
         val -= floor(val);
-        val *= 256;
+        val = ldexp(val, 32);
+    }
+    trimZeroes(dst);
+}
+Arb doubleToArb(double val, int accu) {
+    Arb out = arbCTR(arbAlloc(4), 1, 0, 0, accu);
+    doubleToArb_into(&out, val);
+    return out;
+}
+Arb intToArb(long long val, int accu) {
+    Arb out = arbCTR(arbAlloc(3), 1, 0, val < 0 ? 1 : 0, accu);
+    unsigned long long abs = val < 0 ? -(unsigned long long)val : val;
+    if(abs >> 32 != 0) {
+        out.mantissa[0] = abs >> 32;
+        out.mantissa[1] = abs;
+        out.len = 2;
+        out.exp = 1;
     }
+    else out.mantissa[0] = abs;
+    trimZeroes(&out);
+    return out;
+}
+DD arbToDD(Arb arb) {
+    DD out;
+    out.hi = arbToDouble(arb);
+    Arb hi = doubleToArb(out.hi, arb.accu);
+    Arb rest = arb_subtract(arb, hi);
+    double lo = arbToDouble(rest);
+    freeArb(hi);
+    freeArb(rest);
+    //Renormalize in case hi was not rounded to nearest
+    double sum = out.hi + lo;
+    out.lo = lo - (sum - out.hi);
+    out.hi = sum;
+    return out;
+}
+Arb ddToArb(DD dd, int accu) {
+    Arb hi = doubleToArb(dd.hi, accu);
+    Arb lo = doubleToArb(dd.lo, accu);
+    Arb out = arb_add(hi, lo);
+    freeArb(hi);
+    freeArb(lo);
     return out;
 }
 double arbToDouble(Arb arb) {
     double out = 0;
-    long i;
-    int maxLen = 8;
-    if(arb.len < 8) maxLen = arb.len;
+    int i;
+    int maxLen = 3;
+    if(arb.len < 3) maxLen = arb.len;
     for(i = 0;i < maxLen;i++) {
-        out += ((double)arb.mantissa[i]) / (double)(1L << (i * 8L));
+        out += ldexp((double)arb.mantissa[i], -32 * i);
     }
-    out *= pow(256.0, (double)arb.exp);
+    //Exponents outside of this range overflow or underflow doubles anyway
+    if(arb.exp > 64) out = INFINITY;
+    else if(arb.exp < -64) out = 0;
+    else out = ldexp(out, 32 * arb.exp);
     if(arb.sign == 1) out = -out;
     return out;
 }
+//Splits the integer one at the largest cached power with fewer digits than count, returns the number of digits in low
+int arbSplitDigits(Arb one, int base, long long count, Arb* highOut, Arb* lowOut) {
+    int blockDigits = radixBlockDigits(base);
+    int level = 0;
+    while(((long long)blockDigits << (level + 1)) < count) level++;
+    int lowDigits = blockDigits << level;
+    Arb power = getRadixPower(base, level);
+    int accu = one.exp + 3;
+    one.accu = accu;
+    power.accu = accu;
+    //high = floor(one/power), low = one - high*power
+    Arb quotient = arb_divide(one, power);
+    Arb high = arb_floor(quotient);
+    Arb product = arb_mult(high, power);
+    Arb low = arb_subtract(one, product);
+    freeArb(quotient);
+    freeArb(product);
+    //The quotient may have been rounded across an integer
+    Arb oneArb = intToArb(1, accu);
+    while(low.sign == 1 || arbCmp(low, power) >= 0) {
+        bool tooLarge = low.sign == 1;
+        Arb newHigh = tooLarge ? arb_subtract(high, oneArb) : arb_add(high, oneArb);
+        Arb newLow = tooLarge ? arb_add(low, power) : arb_subtract(low, power);
+        freeArb(high);
+        freeArb(low);
+        high = newHigh;
+        low = newLow;
+    }
+    freeArb(oneArb);
+    *highOut = high;
+    *lowOut = low;
+    return lowDigits;
+}
+typedef struct DigitConversionStruct {
+    Arb one;
+    int base;
+    int count;
+    unsigned char* out;
+} DigitConversion;
+void arbRunDigitConversion(void* arg);
+//Writes the integer one to out as count digits with leading zeros, one must be less than base^count
+void arbIntToDigits(Arb one, int base, int count, unsigned char* out) {
+    int blockDigits = radixBlockDigits(base);
+    if(one.len == 1 && one.mantissa[0] == 0) {
+        memset(out, '0', count);
+        return;
+    }
+    //Small numbers are divided by base^blockDigits, which gives a block of digits at a time
+    if(one.exp < 16) {
+        int limbCount = one.exp + 1;
+        uint32_t limbs[limbCount];
+        memset(limbs, 0, sizeof(limbs));
+        memcpy(limbs, one.mantissa, (one.len < limbCount ? one.len : limbCount) * sizeof(uint32_t));
+        uint32_t blockBase = getRadixPower(base, 0).mantissa[0];
+        int pos = count;
+        while(pos > 0) {
+            uint64_t remainder = 0;
+            for(int i = 0;i < limbCount;i++) {
+                uint64_t cur = remainder << 32 | limbs[i];
+                limbs[i] = cur / blockBase;
+                remainder = cur % blockBase;
+            }
+            for(int i = 0;i < blockDigits && pos > 0;i++) {
+                out[--pos] = numberChars[remainder % base];
+                remainder /= base;
+            }
+        }
+        return;
+    }
+    Arb high, low;
+    int lowDigits = arbSplitDigits(one, base, count, &high, &low);
+    //The halves write to separate parts of out, so they can be converted in parallel
+    DigitConversion halves[2] = {
+        { high,base,count - lowDigits,out },
+        { low,base,lowDigits,out + count - lowDigits },
+    };
+    arbRunAll(&arbRunDigitConversion, halves, sizeof(DigitConversion), 2, arbUseThreads(one.exp));
+    freeArb(high);
+    freeArb(low);
+}
+void arbRunDigitConversion(void* arg) {
+    DigitConversion* conversion = arg;
+    arbIntToDigits(conversion->one, conversion->base, conversion->count, conversion->out);
+}
+char* formatDigits(unsigned char* digits, int digitCount, int exponent);
 char* arbToString(Arb arb, int base, int digitCount) {
     if(arb.len == 0 || (arb.len == 1 && arb.mantissa[0] == 0)) {
         char* out = calloc(2, 1);
         out[0] = '0';
         return out;
     }
-    if(base == 16) {
-        int outPos = 0;
-        char* out = calloc(arb.len * 2 + 2, 1);
-        if(arb.exp < 0) {
-            //out = realloc(
-        }
-        int i;
-        for(i = 0;i < arb.len;i++) {
-            unsigned char val = arb.mantissa[i];
-            if(outPos != 0 || val >> 4 != 0) out[outPos++] = numberChars[val >> 4];
-            if(i != arb.len - 1 || (val & 15) == 0) out[outPos++] = numberChars[val & 15];
-            if(arb.exp - i) out[outPos++] = '.';
-        }
+    if(arb.sign == 1) {
+        arb.sign = 0;
+        char* abs = arbToString(arb, base, digitCount);
+        char* out = calloc(strlen(abs) + 2, 1);
+        out[0] = '-';
+        strcpy(out + 1, abs);
+        free(abs);
         return out;
     }
-    Arb floor = arb_floor(arb);
-    Arb fraction = arb_subtract(arb, floor);
-    unsigned char digits[digitCount + 10];
-    memset(digits, 0, digitCount + 10);
-    int i = digitCount + 10;
-    int exponent = 0;
-    //Add integer digits
-    while(floor.len != 1 || floor.mantissa[0] != 0) {
-        i--;
-        int digit = 0;
-        Arb new = arb_divModInt(floor, base, &digit);
-        freeArb(floor);
-        digits[i] = numberChars[digit];
-        floor = new;
-        if(i == 0) {
-            memmove(digits + 10, digits, digitCount);
-            i = 10;
-        }
-    }
-    freeArb(floor);
-    if(i != digitCount + 10) {
-        memmove(digits, digits + i, digitCount + 10 - i);
-        memset(digits + digitCount + 10 - i, 0, i);
-    }
-    i = digitCount + 10 - i;
-    exponent = i - 1;
-    //Remove trailing zeros fraction if floor==0
-    while(digits[0] == '\0') {
-        Arb newFraction = multByInt(fraction, base);
-        freeArb(fraction);
-        fraction = newFraction;
-        //If newfraction is not zero: append to list and break
-        if(fraction.exp == 0) {
-            digits[0] = numberChars[fraction.mantissa[0]];
-            fraction.mantissa[0] = 0;
-            i++;
-            break;
-        }
-        exponent--;
-    }
-    //Fractional Digits (repeatedly multByInt)
-    for(;i < digitCount;i++) {
-        Arb newFraction = multByInt(fraction, base);
-        freeArb(fraction);
-        fraction = newFraction;
-        //If (fraction equals zero) break;
-        if(fraction.len == 1 && fraction.mantissa[0] == 0) break;
-        //Get digit to add
-        char digitToAdd = '0';
-        if(fraction.exp == 0) {
-            digitToAdd = numberChars[fraction.mantissa[0]];
-            fraction.mantissa[0] = 0;
-        }
-        digits[i] = digitToAdd;
-    }
-    freeArb(fraction);
+    /*
+        Scale arb by a power of base to an integer with digitCount digits, then convert it with divide and conquer.
+        The exponent estimate can be off by one, which shows up as an extra or missing leading digit.
+    */
+    double log2Value = 32.0 * arb.exp + log2(arb.mantissa[0] + (arb.len > 1 ? arb.mantissa[1] / 4294967296.0 : 0));
+    int exponent = floor(log2Value / log2(base));
+    int workAccu = (digitCount + 2) * log2(base) / 32 + 3;
+    unsigned char* digits = malloc(digitCount + 2);
+    while(true) {
+        int scale = digitCount - 1 - exponent;
+        Arb baseArb = intToArb(base, workAccu);
+        Arb scaleArb = intToArb(scale < 0 ? -scale : scale, workAccu);
+        Arb factor = arb_pow(baseArb, scaleArb);
+        Arb scaled = scale < 0 ? arb_divide(arb, factor) : arb_mult(arb, factor);
+        //Round to the nearest integer
+        Arb half = arbPow2(-1, workAccu);
+        Arb rounded = arb_add(scaled, half);
+        Arb integer = arb_floor(rounded);
+        arbIntToDigits(integer, base, digitCount + 1, digits);
+        freeArb(baseArb);
+        freeArb(scaleArb);
+        freeArb(factor);
+        freeArb(scaled);
+        freeArb(half);
+        freeArb(rounded);
+        freeArb(integer);
+        if(digits[0] != '0') exponent++;
+        else if(digits[1] == '0') exponent--;
+        else break;
+    }
+    //Remove the leading zero
+    memmove(digits, digits + 1, digitCount);
+    return formatDigits(digits, digitCount, exponent);
+}
+//Formats digitCount digit characters with exponent as the position of the first, digits needs one extra byte and is freed
+char* formatDigits(unsigned char* digits, int digitCount, int exponent) {
+    //Remove trailing zeros
+    int end = digitCount;
+    bool useExponent = exponent < -15 || exponent >= digitCount;
+    while(end > 1 && (useExponent || end > exponent + 1) && digits[end - 1] == '0') end--;
+    digits[end] = '\0';
     //Turn digits into printable number
     int digitLen = strlen((char*)digits);
     //Write in exponent notation
-    if(exponent < -15 || exponent > digitCount) {
-        char* out = calloc(digitLen + 12, 1);
+    if(useExponent) {
+        char* out = calloc(digitLen + 16, 1);
         out[0] = digits[0];
-        out[1] = '.';
-        memcpy(out + 2, digits + 1, digitLen - 1);
-        out[digitLen + 1] = 'e';
-        snprintf(out + digitLen + 2, 8, "%d", exponent);
+        int outPos = 1;
+        if(digitLen > 1) {
+            out[1] = '.';
+            memcpy(out + 2, digits + 1, digitLen - 1);
+            outPos = digitLen + 1;
+        }
+        out[outPos] = 'e';
+        snprintf(out + outPos + 1, 14, "%d", exponent);
+        free(digits);
         return out;
     }
     //Write fractional number with zero padding
@@ -286,6 +810,7 @@ char* arbToString(Arb arb, int base, int digitCount) {
         out[1] = '.';
         memset(out + 2, '0', -exponent - 1);
         memcpy(out - exponent + 1, digits, digitLen);
+        free(digits);
         return out;
     }
     //Write normally
@@ -296,45 +821,195 @@ char* arbToString(Arb arb, int base, int digitCount) {
             out[outPos++] = digits[i];
             if(i == exponent && i != digitLen - 1) out[outPos++] = '.';
         }
+        free(digits);
         return out;
     }
 }
+/**
+ * Destination of arbWriteDigits
+ * @param written Number of digits written so far
+ * @param pointAfter Number of digits before the decimal point, 0 for no point
+ * @param pendingZeroes Zeros that are only written once a nonzero digit follows them, so trailing zeros are dropped
+ */
+typedef struct DigitStreamStruct {
+    FILE* file;
+    long long written;
+    long long pointAfter;
+    long long pendingZeroes;
+} DigitStream;
+//Writes digits at the current position, with the decimal point where it belongs
+void emitDigits(DigitStream* stream, const unsigned char* digits, long long count) {
+    long long split = stream->pointAfter - stream->written;
+    if(stream->pointAfter > 0 && split >= 0 && split < count) {
+        fwrite(digits, 1, split, stream->file);
+        fputc('.', stream->file);
+        fwrite(digits + split, 1, count - split, stream->file);
+    }
+    else fwrite(digits, 1, count, stream->file);
+    stream->written += count;
+}
+void emitZeroes(DigitStream* stream, long long count) {
+    const unsigned char zeroes[64] = "0000000000000000000000000000000000000000000000000000000000000000";
+    while(count > 0) {
+        long long chunk = count < 64 ? count : 64;
+        emitDigits(stream, zeroes, chunk);
+        count -= chunk;
+    }
+}
+void streamDigits(DigitStream* stream, const unsigned char* digits, long long count) {
+    long long i = 0;
+    while(i < count) {
+        long long start = i;
+        while(i < count && digits[i] == '0') i++;
+        stream->pendingZeroes += i - start;
+        if(i == count) break;
+        start = i;
+        while(i < count && digits[i] != '0') i++;
+        emitZeroes(stream, stream->pendingZeroes);
+        stream->pendingZeroes = 0;
+        emitDigits(stream, digits + start, i - start);
+    }
+}
+//Writes the zeros that are before the decimal point, the rest are trailing
+void finishDigits(DigitStream* stream) {
+    long long kept = stream->pointAfter - stream->written;
+    if(kept > stream->pendingZeroes) kept = stream->pendingZeroes;
+    if(kept > 0) emitZeroes(stream, kept);
+    stream->pendingZeroes = 0;
+}
+//arbIntToDigits, but each half is written to the stream as soon as it is converted
+void arbIntStreamDigits(Arb one, int base, long long count, DigitStream* stream) {
+    //Leaves have at most 16 digits, which is 512 digits in base 2
+    unsigned char digits[1024];
+    if(one.exp < 16 || arbIsZero(one)) {
+        memset(digits, '0', sizeof(digits));
+        while(count > (long long)sizeof(digits)) {
+            long long zeroes = count - sizeof(digits) < sizeof(digits) ? count - sizeof(digits) : sizeof(digits);
+            streamDigits(stream, digits, zeroes);
+            count -= zeroes;
+        }
+        arbIntToDigits(one, base, count, digits);
+        streamDigits(stream, digits, count);
+        return;
+    }
+    Arb high, low;
+    int lowDigits = arbSplitDigits(one, base, count, &high, &low);
+    arbIntStreamDigits(high, base, count - lowDigits, stream);
+    freeArb(high);
+    arbIntStreamDigits(low, base, lowDigits, stream);
+    freeArb(low);
+}
+long long arbWriteDigits(Arb arb, int base, int digitCount, FILE* file) {
+    if(arbIsZero(arb)) {
+        fputc('0', file);
+        return 1;
+    }
+    if(arb.sign == 1) fputc('-', file);
+    arb.sign = 0;
+    //Same scaling as arbToString, but the digit count is checked against base^digitCount instead of converting every attempt
+    double log2Value = 32.0 * arb.exp + log2(arb.mantissa[0] + (arb.len > 1 ? arb.mantissa[1] / 4294967296.0 : 0));
+    int exponent = floor(log2Value / log2(base));
+    int workAccu = (digitCount + 2) * log2(base) / 32 + 3;
+    Arb baseArb = intToArb(base, workAccu);
+    Arb countArb = intToArb(digitCount, workAccu);
+    Arb upper = arb_pow(baseArb, countArb);
+    Arb lower = arbDivInt(upper, base);
+    Arb integer;
+    while(true) {
+        int scale = digitCount - 1 - exponent;
+        Arb scaleArb = intToArb(scale < 0 ? -scale : scale, workAccu);
+        Arb factor = arb_pow(baseArb, scaleArb);
+        Arb scaled = scale < 0 ? arb_divide(arb, factor) : arb_mult(arb, factor);
+        Arb half = arbPow2(-1, workAccu);
+        Arb rounded = arb_add(scaled, half);
+        integer = arb_floor(rounded);
+        freeArb(scaleArb);
+        freeArb(factor);
+        freeArb(scaled);
+        freeArb(half);
+        freeArb(rounded);
+        if(arbCmp(integer, upper) >= 0) exponent++;
+        else if(arbCmp(integer, lower) < 0) exponent--;
+        else break;
+        freeArb(integer);
+    }
+    freeArb(baseArb);
+    freeArb(countArb);
+    freeArb(upper);
+    freeArb(lower);
+    long long count = digitCount;
+    //Integers are written without the zeros after the decimal point
+    if(arb.exp >= arb.len - 1 && exponent + 1 < digitCount) {
+        freeArb(integer);
+        integer = copyArb(arb);
+        count = exponent + 1;
+    }
+    DigitStream stream;
+    stream.file = file;
+    stream.written = 0;
+    stream.pendingZeroes = 0;
+    bool useExponent = exponent < -15 || exponent >= digitCount;
+    if(useExponent) stream.pointAfter = 1;
+    else if(exponent < 0) {
+        fputs("0.", file);
+        for(int i = 0;i < -exponent - 1;i++) fputc('0', file);
+        stream.pointAfter = 0;
+    }
+    else stream.pointAfter = exponent + 1;
+    arbIntStreamDigits(integer, base, count, &stream);
+    finishDigits(&stream);
+    freeArb(integer);
+    if(useExponent) fprintf(file, "e%d", exponent);
+    return stream.written;
+}
 #pragma endregion
 #pragma region Arbitary Precision Functions
 Arb multByInt(Arb one, int two) {
-    int carry = 0;
+    uint64_t carry = 0;
     int i;
     char sign = two < 0 ? 1 : 0;
-    Arb out = arbCTR(calloc(one.len + 4, 1), one.len, one.exp, one.sign ^ sign, one.accu);
-    if(two < 0) two = -two;
+    Arb out = arbCTR(arbAlloc(one.len + 2), one.len, one.exp, one.sign ^ sign, one.accu);
+    uint64_t factor = two < 0 ? -(int64_t)two : two;
     for(i = one.len - 1;i >= 0;i--) {
-        int new = carry + (int)one.mantissa[i] * two;
-        carry = new / 256;
+        uint64_t new = carry + one.mantissa[i] * factor;
+        carry = new >> 32;
         out.mantissa[i] = new;
     }
-    while(carry != 0) {
-        int new = carry + (int)one.mantissa[i] * two;
-        carry = new / 256;
+    //The carry is less than 2^31, so it is a single digit
+    if(carry != 0) {
+        memmove(out.mantissa + 1, out.mantissa, out.len * sizeof(uint32_t));
         out.len++;
-        if(out.len > out.accu) out.len = out.accu;
-        memmove(out.mantissa + 1, out.mantissa, out.len - 1);
-        out.mantissa[0] = new;
+        out.mantissa[0] = carry;
         out.exp++;
     }
     trimZeroes(&out);
     return out;
 }
-Arb arb_divModInt(Arb one, unsigned char two, int* carryOut) {
+//Returns one/two rounded to one.accu digits
+Arb arbDivInt(Arb one, uint32_t two) {
+    int outlen = one.accu + 1;
+    Arb out = arbCTR(arbAlloc(outlen + 1), outlen, one.exp, one.sign, one.accu);
+    uint64_t carry = 0;
+    for(int i = 0;i < outlen;i++) {
+        uint64_t cur = carry << 32;
+        if(i < one.len) cur += one.mantissa[i];
+        out.mantissa[i] = cur / two;
+        carry = cur % two;
+    }
+    trimZeroes(&out);
+    return out;
+}
+Arb arb_divModInt(Arb one, uint32_t two, int* carryOut) {
     //Returs one/two and sets carryOut to the remainder.
     //Return value is an integer Arb
     //one is treated as an integer Arb
     int outlen = one.exp + 1;
     if(outlen > one.accu) outlen = one.accu;
-    Arb out = arbCTR(calloc(outlen, 1), outlen, outlen - 1, one.sign ^ (two < 0 ? 1 : 0), one.accu);
-    int carry = 0;
+    Arb out = arbCTR(arbAlloc(outlen + 1), outlen, outlen - 1, one.sign, one.accu);
+    uint64_t carry = 0;
     for(int i = 0; i < outlen; i++) {
-        int cur = carry * 256;
-        cur += one.mantissa[i];
+        uint64_t cur = carry << 32;
+        if(i < one.len) cur += one.mantissa[i];
         out.mantissa[i] = cur / two;
         carry = cur % two;
     }
@@ -344,16 +1019,16 @@ Arb arb_divModInt(Arb one, unsigned char two, int* carryOut) {
         //Number of powers
         int exp = one.exp - one.accu + 1;
         int i = 0;
-        //Current power (256^(2^i))
-        int curPow = 256 % two;
-        //Calculate Cout as (256^exp)%base
-        int Cout = 1;
+        //Current power (2^32^(2^i))
+        uint64_t curPow = (1ULL << 32) % two;
+        //Calculate Cout as (2^32^exp)%base
+        uint64_t Cout = 1;
         while(exp != 0) {
             //If ith bit is one
             if((exp & (1 << i)) != 0) {
                 //Set ith bit to zero
                 exp ^= 1 << i;
-                //Multiply CarryOut by 256^(2^i)
+                //Multiply CarryOut by 2^32^(2^i)
                 Cout *= curPow;
                 Cout %= two;
                 if(Cout == 0) break;
@@ -364,7 +1039,7 @@ Arb arb_divModInt(Arb one, unsigned char two, int* carryOut) {
             if(curPow == 0) break;
             i++;
         }
-        // carryOut = mod(carry*(256^exp),base)
+        // carryOut = mod(carry*(2^32^exp),base)
         *carryOut = (carry * Cout) % two;
     }
     else *carryOut = carry;
@@ -376,35 +1051,44 @@ Arb arb_floor(Arb one) {
         int outlen = one.len;
         if(outlen > one.exp + 1) outlen = one.exp + 1;
         if(outlen > one.accu) outlen = one.accu;
-        Arb out = arbCTR(calloc(outlen + 1, 1), outlen, one.exp, one.sign, one.accu);
-        memcpy(out.mantissa, one.mantissa, outlen);
+        Arb out = arbCTR(arbAlloc(outlen + 1), outlen, one.exp, one.sign, one.accu);
+        memcpy(out.mantissa, one.mantissa, outlen * sizeof(uint32_t));
         return out;
     }
     //else return 0
     else {
-        return arbCTR(calloc(1, 1), 1, 0, 0, one.accu);
+        return arbCTR(arbAlloc(1), 1, 0, 0, one.accu);
     }
 }
-Arb arb_add(Arb one, Arb two) {
+//Number of digits needed for one+two or one-two, with one extra digit to round to accu with
+int arbSumLen(Arb one, Arb two, int accu) {
+    int exp = one.exp > two.exp ? one.exp : two.exp;
+    int oneLen = one.len + exp - one.exp, twoLen = two.len + exp - two.exp;
+    int len = oneLen > twoLen ? oneLen : twoLen;
+    return len > accu + 1 ? accu + 1 : len;
+}
+void arb_add_into(Arb* dst, Arb one, Arb two) {
+    //A zero's exponent says nothing about the other term's position
+    if(arbIsZero(two)) {
+        arb_set_into(dst, one);
+        return;
+    }
+    if(arbIsZero(one)) {
+        arb_set_into(dst, two);
+        return;
+    }
     if(one.sign != two.sign) {
-        Arb out;
-        if(one.sign == 1) {
-            one.sign = 0;
-            out = arb_subtract(two, one);
-            one.sign = 1;
-        }
-        if(one.sign == 0) {
-            two.sign = 0;
-            out = arb_subtract(one, two);
-            two.sign = 1;
-        }
-        return out;
+        //one+two = one-(-two)
+        two.sign = one.sign;
+        arb_subtract_into(dst, one, two);
+        return;
     }
-    Arb out;
-    out.accu = one.accu;
+    //Digits are read at or to the left of the digit being written, so dst may be one or two
+    Arb out = *dst;
     out.exp = one.exp > two.exp ? one.exp : two.exp;
     out.sign = one.sign;
-    int carry = 0, oneDiff = 0, twoDiff = 0;
+    uint64_t carry = 0;
+    int oneDiff = 0, twoDiff = 0;
     int oneLen = one.len, twoLen = two.len;
     if(one.exp > two.exp) {
         twoDiff = one.exp - two.exp;
@@ -414,208 +1098,2797 @@ Arb arb_add(Arb one, Arb two) {
         oneDiff = two.exp - one.exp;
         oneLen += oneDiff;
     }
-    out.len = oneLen > twoLen ? oneLen : twoLen;
-    if(out.len > out.accu) out.len = out.accu;
-    unsigned char* outmant = calloc(out.len + 1, 1);
-    one.mantissa -= oneDiff;
-    two.mantissa -= twoDiff;
+    out.len = arbSumLen(one, two, out.accu);
+    uint32_t* outmant = out.mantissa;
     int i;
     for(i = out.len - 1;i >= 0;i--) {
-        int oneCell = one.mantissa[i];
-        int twoCell = two.mantissa[i];
-        if(i > twoLen || i < twoDiff) twoCell = 0;
-        if(i > oneLen || i < oneDiff) oneCell = 0;
-        int new = oneCell + twoCell + carry;
+        uint64_t oneCell = 0, twoCell = 0;
+        if(i >= oneDiff && i < oneLen) oneCell = one.mantissa[i - oneDiff];
+        if(i >= twoDiff && i < twoLen) twoCell = two.mantissa[i - twoDiff];
+        uint64_t new = oneCell + twoCell + carry;
         outmant[i] = new;
-        carry = new / 256;
+        carry = new >> 32;
     }
-    one.mantissa += oneDiff;
-    two.mantissa += twoDiff;
     if(carry != 0) {
-        if(out.len == out.accu) out.len--;
-        memmove(outmant + 1, outmant, out.len);
+        if(out.len == out.accu + 1) out.len--;
+        memmove(outmant + 1, outmant, out.len * sizeof(uint32_t));
         out.len++;
         out.exp++;
         outmant[0] = carry;
     }
-    out.mantissa = outmant;
+    outmant[out.len] = 0;
     trimZeroes(&out);
-    return out;
+    *dst = out;
 }
-Arb arb_subtract(Arb one, Arb two) {
+void arb_subtract_into(Arb* dst, Arb one, Arb two) {
+    if(arbIsZero(two)) {
+        arb_set_into(dst, one);
+        return;
+    }
+    if(arbIsZero(one)) {
+        arb_set_into(dst, two);
+        if(!arbIsZero(*dst)) dst->sign ^= 1;
+        return;
+    }
     if(one.sign != two.sign) {
+        //one-two = one+(-two)
         two.sign = one.sign;
-        Arb out = arb_add(one, two);
-        two.sign = one.sign == 0 ? 1 : 0;
-        out.sign = one.sign;
-        return out;
+        arb_add_into(dst, one, two);
+        return;
     }
     if(arbCmp(one, two) == -1) {
-        Arb out = arb_subtract(two, one);
-        out.sign ^= 1;
-        return out;
+        arb_subtract_into(dst, two, one);
+        if(dst->len != 1 || dst->mantissa[0] != 0) dst->sign ^= 1;
+        return;
     }
-    Arb out;
+    Arb out = *dst;
     out.sign = one.sign;
     out.exp = one.exp;
     int twoDiff = one.exp - two.exp;
-    out.accu = one.accu > two.accu ? one.accu : two.accu;
-    out.len = two.len + twoDiff > one.len ? two.len + twoDiff : one.len;
-    if(out.len > out.accu) out.len = out.accu;
-    two.mantissa -= twoDiff;
-    unsigned char* outMant = calloc(out.len, 1);
-    int i, carry = 0;
+    out.len = arbSumLen(one, two, out.accu);
+    uint32_t* outMant = out.mantissa;
+    int i;
+    uint64_t borrow = 0;
     for(i = out.len - 1;i >= 0;i--) {
-        int oneCell = one.mantissa[i];
-        int twoCell = two.mantissa[i];
-        if(i > one.len) oneCell = 0;
-        if(i >= two.len + twoDiff || i < twoDiff) twoCell = 0;
-        int new = oneCell - twoCell + carry;
-        outMant[i] = new;
-        carry = new < 0 ? -1 : 0;
-    }
-    two.mantissa += twoDiff;
-    if(carry != 0) error("Fatal error in subtraction");
-    out.mantissa = outMant;
+        uint64_t oneCell = 0, twoCell = 0;
+        if(i < one.len) oneCell = one.mantissa[i];
+        if(i >= twoDiff && i < two.len + twoDiff) twoCell = two.mantissa[i - twoDiff];
+        uint64_t sub = twoCell + borrow;
+        outMant[i] = oneCell - sub;
+        borrow = oneCell < sub;
+    }
+    if(borrow != 0) error("Fatal error in subtraction");
+    outMant[out.len] = 0;
     trimZeroes(&out);
+    *dst = out;
+}
+Arb arb_add(Arb one, Arb two) {
+    int accu = one.accu > two.accu ? one.accu : two.accu;
+    Arb out = arbCTR(arbAlloc(arbSumLen(one, two, accu) + 2), 1, 0, 0, accu);
+    arb_add_into(&out, one, two);
     return out;
 }
-Arb arb_mult(Arb one, Arb two) {
-    if(one.len > two.len) {
-        Arb tmp = one;
-        one = two;
-        two = tmp;
+Arb arb_subtract(Arb one, Arb two) {
+    int accu = one.accu > two.accu ? one.accu : two.accu;
+    Arb out = arbCTR(arbAlloc(arbSumLen(one, two, accu) + 2), 1, 0, 0, accu);
+    arb_subtract_into(&out, one, two);
+    return out;
+}
+#pragma region Multiplication Kernels
+//Below these lengths (in digits of the shorter factor) the next simplest algorithm is used
+int karatsubaThreshold = 32;
+int toomThreshold = 120;
+int nttThreshold = 12000;
+/*
+    The kernels below work on raw big-endian digit arrays (digit 0 is the most significant) and
+    always produce the full, exact product of aLen+bLen digits.
+    Negative intermediate values in Toom-3 are stored in two's complement with a fixed width.
+*/
+void digitMult(const uint32_t* a, int aLen, const uint32_t* b, int bLen, uint32_t* out);
+void nttMultiply(const uint32_t* a, int aLen, const uint32_t* b, int bLen, uint32_t* out, bool decimal);
+void digitMultSigned(const uint32_t* a, const uint32_t* b, int len, uint32_t* out);
+//An independent product in Karatsuba or Toom-3, signed products are two's complement with a width of aLen
+typedef struct DigitProductStruct {
+    const uint32_t* a;
+    int aLen;
+    const uint32_t* b;
+    int bLen;
+    uint32_t* out;
+    bool isSigned;
+} DigitProduct;
+void digitRunProduct(void* arg) {
+    DigitProduct* product = arg;
+    if(product->isSigned) digitMultSigned(product->a, product->b, product->aLen, product->out);
+    else digitMult(product->a, product->aLen, product->b, product->bLen, product->out);
+}
+//Adds src to the number dst (aligned by the least significant digit), carrying into dst
+void digitAddInto(uint32_t* dst, int dstLen, const uint32_t* src, int srcLen) {
+    //Digits of src that do not fit in dst are ignored (they are leading zeroes or overflow)
+    uint64_t carry = 0;
+    int i = dstLen - 1, j = srcLen - 1;
+    for(;j >= 0 && i >= 0;i--, j--) {
+        uint64_t new = (uint64_t)dst[i] + src[j] + carry;
+        dst[i] = new;
+        carry = new >> 32;
+    }
+    for(;carry != 0 && i >= 0;i--) {
+        uint64_t new = dst[i] + carry;
+        dst[i] = new;
+        carry = new >> 32;
+    }
+}
+//Subtracts src from dst (aligned by the least significant digit), borrowing from dst
+void digitSubFrom(uint32_t* dst, int dstLen, const uint32_t* src, int srcLen) {
+    uint32_t borrow = 0;
+    int i = dstLen - 1, j = srcLen - 1;
+    for(;j >= 0 && i >= 0;i--, j--) {
+        uint64_t sub = (uint64_t)src[j] + borrow;
+        borrow = dst[i] < sub;
+        dst[i] -= sub;
+    }
+    for(;borrow != 0 && i >= 0;i--) {
+        borrow = dst[i] == 0;
+        dst[i]--;
+    }
+}
+//Negates a two's complement number
+void digitNegate(uint32_t* dst, int len) {
+    uint64_t carry = 1;
+    for(int i = len - 1;i >= 0;i--) {
+        uint64_t new = (uint64_t)(uint32_t)~dst[i] + carry;
+        dst[i] = new;
+        carry = new >> 32;
+    }
+}
+//Divides a two's complement number by two
+void digitHalve(uint32_t* dst, int len) {
+    uint32_t carry = dst[0] >> 31;
+    for(int i = 0;i < len;i++) {
+        uint32_t new = (dst[i] >> 1) | (carry << 31);
+        carry = dst[i] & 1;
+        dst[i] = new;
+    }
+}
+//Divides a two's complement number by three, the number must be a multiple of three
+void digitDivExact3(uint32_t* dst, int len) {
+    //0xAAAAAAAB is the inverse of 3 mod 2^32
+    uint32_t carry = 0;
+    for(int i = len - 1;i >= 0;i--) {
+        uint32_t borrow = dst[i] < carry;
+        uint32_t quotient = (dst[i] - carry) * 0xAAAAAAABu;
+        dst[i] = quotient;
+        carry = ((uint64_t)quotient * 3 >> 32) + borrow;
+    }
+}
+//Schoolbook O(n^2) multiplication
+void digitMultSchool(const uint32_t* a, int aLen, const uint32_t* b, int bLen, uint32_t* out) {
+    memset(out, 0, (aLen + bLen) * sizeof(uint32_t));
+    int i, j;
+    for(i = aLen - 1;i >= 0;i--) {
+        uint64_t aVal = a[i], carry = 0;
+        uint32_t* m = out + i + 1;
+        for(j = bLen - 1;j >= 0;j--) {
+            uint64_t new = aVal * b[j] + m[j] + carry;
+            m[j] = new;
+            carry = new >> 32;
+        }
+        out[i] = carry;
+    }
+}
+//Multiplies a by the single digit b
+void digitMultDigit(const uint32_t* a, int aLen, uint32_t b, uint32_t* out) {
+    uint64_t carry = 0;
+    for(int i = aLen - 1;i >= 0;i--) {
+        uint64_t new = (uint64_t)a[i] * b + carry;
+        out[i + 1] = new;
+        carry = new >> 32;
+    }
+    out[0] = carry;
+}
+/*
+    Fixed size kernels for square products of up to ARB_FIXED_MAX digits (512 bits)
+    The loop bounds are constants, so the compiler unrolls them and keeps the product on the stack
+*/
+#define ARB_FIXED_KERNEL(N) \
+void digitMultFixed##N(const uint32_t* a, const uint32_t* b, uint32_t* out) { \
+    uint32_t product[2 * N] = { 0 }; \
+    for(int i = N - 1;i >= 0;i--) { \
+        uint64_t aVal = a[i], carry = 0; \
+        for(int j = N - 1;j >= 0;j--) { \
+            uint64_t new = aVal * b[j] + product[i + j + 1] + carry; \
+            product[i + j + 1] = new; \
+            carry = new >> 32; \
+        } \
+        product[i] = carry; \
+    } \
+    memcpy(out, product, sizeof(product)); \
+}
+ARB_FIXED_KERNEL(2) ARB_FIXED_KERNEL(3) ARB_FIXED_KERNEL(4) ARB_FIXED_KERNEL(5)
+ARB_FIXED_KERNEL(6) ARB_FIXED_KERNEL(7) ARB_FIXED_KERNEL(8) ARB_FIXED_KERNEL(9)
+ARB_FIXED_KERNEL(10) ARB_FIXED_KERNEL(11) ARB_FIXED_KERNEL(12) ARB_FIXED_KERNEL(13)
+ARB_FIXED_KERNEL(14) ARB_FIXED_KERNEL(15) ARB_FIXED_KERNEL(16)
+#undef ARB_FIXED_KERNEL
+void (*const digitMultFixed[ARB_FIXED_MAX + 1])(const uint32_t* a, const uint32_t* b, uint32_t* out) = {
+    NULL,NULL,&digitMultFixed2,&digitMultFixed3,&digitMultFixed4,&digitMultFixed5,&digitMultFixed6,
+    &digitMultFixed7,&digitMultFixed8,&digitMultFixed9,&digitMultFixed10,&digitMultFixed11,
+    &digitMultFixed12,&digitMultFixed13,&digitMultFixed14,&digitMultFixed15,&digitMultFixed16,
+};
+//Karatsuba multiplication, requires (aLen+1)/2 < bLen <= aLen
+void digitMultKaratsuba(const uint32_t* a, int aLen, const uint32_t* b, int bLen, uint32_t* out) {
+    //a = a1*2^(32h) + a0, b = b1*2^(32h) + b0
+    int h = (aLen + 1) / 2;
+    int a1Len = aLen - h, b1Len = bLen - h;
+    const uint32_t* a0 = a + a1Len, * b0 = b + b1Len;
+    int outLen = aLen + bLen;
+    long long mark = arbArenaMark();
+    uint32_t* scratch = arbScratch(4 * h + 4);
+    uint32_t* aSum = scratch, * bSum = scratch + h + 1, * z1 = scratch + 2 * h + 2;
+    memcpy(aSum + 1, a0, h * sizeof(uint32_t));
+    digitAddInto(aSum, h + 1, a, a1Len);
+    memcpy(bSum + 1, b0, h * sizeof(uint32_t));
+    digitAddInto(bSum, h + 1, b, b1Len);
+    //out = a1*b1*2^(64h) + a0*b0, and z1 = (a0+a1)*(b0+b1) - a0*b0 - a1*b1
+    memset(out, 0, outLen * sizeof(uint32_t));
+    DigitProduct products[3] = {
+        { a0,h,b0,h,out + outLen - 2 * h,false },
+        { a,a1Len,b,b1Len,out,false },
+        { aSum,h + 1,bSum,h + 1,z1,false },
+    };
+    arbRunAll(&digitRunProduct, products, sizeof(DigitProduct), 3, arbUseThreads(bLen));
+    digitSubFrom(z1, 2 * h + 2, out + outLen - 2 * h, 2 * h);
+    digitSubFrom(z1, 2 * h + 2, out, a1Len + b1Len);
+    digitAddInto(out, outLen - h, z1, 2 * h + 2);
+    arbArenaRelease(mark);
+}
+//Multiplies two's complement numbers of width len, out has a width of 2*len
+void digitMultSigned(const uint32_t* a, const uint32_t* b, int len, uint32_t* out) {
+    long long mark = arbArenaMark();
+    uint32_t* absolute = arbScratch(len * 2);
+    memcpy(absolute, a, len * sizeof(uint32_t));
+    memcpy(absolute + len, b, len * sizeof(uint32_t));
+    bool aNeg = a[0] >> 31, bNeg = b[0] >> 31;
+    if(aNeg) digitNegate(absolute, len);
+    if(bNeg) digitNegate(absolute + len, len);
+    digitMult(absolute, len, absolute + len, len, out);
+    if(aNeg ^ bNeg) digitNegate(out, len * 2);
+    arbArenaRelease(mark);
+}
+//Toom-3 multiplication with evaluation points 0, 1, -1, -2 and infinity, requires 2*ceil(aLen/3) < bLen <= aLen
+void digitMultToom3(const uint32_t* a, int aLen, const uint32_t* b, int bLen, uint32_t* out) {
+    //a = a2*x^2 + a1*x + a0 where x=2^(32k)
+    int k = (aLen + 2) / 3;
+    //Width of the evaluated values and the width of their products
+    int w = k + 2, pw = 2 * w;
+    long long mark = arbArenaMark();
+    uint32_t* scratch = arbScratch(8 * w + 5 * pw);
+    uint32_t* aPos = scratch, * bPos = scratch + w, * aNeg = scratch + 2 * w, * bNeg = scratch + 3 * w;
+    uint32_t* aNeg2 = scratch + 4 * w, * bNeg2 = scratch + 5 * w, * tmp = scratch + 6 * w;
+    uint32_t* r1 = scratch + 8 * w, * rNeg1 = r1 + pw, * rNeg2 = r1 + 2 * pw, * r2 = r1 + 3 * pw, * r3 = r1 + 4 * pw;
+    const uint32_t* factors[2] = { a,b };
+    int lens[2] = { aLen,bLen };
+    for(int i = 0;i < 2;i++) {
+        const uint32_t* f = factors[i];
+        int len = lens[i];
+        const uint32_t* f0 = f + len - k, * f1 = f + len - 2 * k;
+        int f2Len = len - 2 * k;
+        uint32_t* pos = i ? bPos : aPos, * neg = i ? bNeg : aNeg, * neg2 = i ? bNeg2 : aNeg2;
+        //f0+f2
+        memcpy(tmp + 2, f0, k * sizeof(uint32_t));
+        memset(tmp, 0, 2 * sizeof(uint32_t));
+        digitAddInto(tmp, w, f, f2Len);
+        //p(1) = f0+f1+f2
+        memcpy(pos, tmp, w * sizeof(uint32_t));
+        digitAddInto(pos, w, f1, k);
+        //p(-1) = f0-f1+f2
+        memcpy(neg, tmp, w * sizeof(uint32_t));
+        digitSubFrom(neg, w, f1, k);
+        //p(-2) = (p(-1)+f2)*2-f0
+        memcpy(neg2, neg, w * sizeof(uint32_t));
+        digitAddInto(neg2, w, f, f2Len);
+        digitAddInto(neg2, w, neg2, w);
+        digitSubFrom(neg2, w, f0, k);
+    }
+    //r0 and rInf are placed directly into out
+    int outLen = aLen + bLen;
+    memset(out, 0, outLen * sizeof(uint32_t));
+    DigitProduct products[5] = {
+        { aPos,w,bPos,w,r1,true },
+        { aNeg,w,bNeg,w,rNeg1,true },
+        { aNeg2,w,bNeg2,w,rNeg2,true },
+        { a + aLen - k,k,b + bLen - k,k,out + outLen - 2 * k,false },
+        { a,aLen - 2 * k,b,bLen - 2 * k,out,false },
+    };
+    arbRunAll(&digitRunProduct, products, sizeof(DigitProduct), 5, arbUseThreads(bLen));
+    const uint32_t* r0 = out + outLen - 2 * k, * rInf = out;
+    int rInfLen = outLen - 4 * k;
+    //Interpolation (Bodrato's sequence)
+    //r3 = (r(-2) - r(1)) / 3
+    memcpy(r3, rNeg2, pw * sizeof(uint32_t));
+    digitSubFrom(r3, pw, r1, pw);
+    digitDivExact3(r3, pw);
+    //r1 = (r(1) - r(-1)) / 2
+    digitSubFrom(r1, pw, rNeg1, pw);
+    digitHalve(r1, pw);
+    //r2 = r(-1) - r(0)
+    memcpy(r2, rNeg1, pw * sizeof(uint32_t));
+    digitSubFrom(r2, pw, r0, 2 * k);
+    //r3 = (r2 - r3) / 2 + 2 * r(inf)
+    digitSubFrom(r3, pw, r2, pw);
+    digitNegate(r3, pw);
+    digitHalve(r3, pw);
+    digitAddInto(r3, pw, rInf, rInfLen);
+    digitAddInto(r3, pw, rInf, rInfLen);
+    //r2 = r2 + r1 - r(inf)
+    digitAddInto(r2, pw, r1, pw);
+    digitSubFrom(r2, pw, rInf, rInfLen);
+    //r1 = r1 - r3
+    digitSubFrom(r1, pw, r3, pw);
+    //Recombine
+    digitAddInto(out, outLen - k, r1, pw);
+    digitAddInto(out, outLen - 2 * k, r2, pw);
+    digitAddInto(out, outLen - 3 * k, r3, pw);
+    arbArenaRelease(mark);
+}
+//Primes of the form c*2^k+1 used for the number theoretic transform, 3 is a primitive root of each
+const uint32_t nttPrimes[3] = { 998244353, 167772161, 469762049 };
+//Maximum aLen+bLen for a single transform, each digit is one coefficient
+#define nttMaxDigits (1 << 23)
+uint32_t nttPowMod(uint64_t base, uint64_t exp, uint32_t mod) {
+    uint64_t out = 1;
+    base %= mod;
+    while(exp != 0) {
+        if(exp & 1) out = out * base % mod;
+        base = base * base % mod;
+        exp >>= 1;
+    }
+    return out;
+}
+//A pass over the coefficients of a transform, split into ranges for the thread pool
+typedef struct NTTPassStruct {
+    uint32_t* a;
+    int n;
+    int half;
+    uint32_t p;
+    const uint32_t* roots;
+} NTTPass;
+void nttBitReverse(void* ctx, int start, int end) {
+    NTTPass* pass = ctx;
+    int n = pass->n;
+    //j is the bit reversal of i
+    int j = 0;
+    for(int bit = n >> 1, i = start;i != 0;bit >>= 1, i >>= 1) if(i & 1) j |= bit;
+    for(int i = start;i < end;i++) {
+        if(i < j) {
+            uint32_t tmp = pass->a[i];
+            pass->a[i] = pass->a[j];
+            pass->a[j] = tmp;
+        }
+        int bit = n >> 1;
+        for(;j & bit;bit >>= 1) j ^= bit;
+        j ^= bit;
+    }
+}
+//Butterflies start to end of one stage, there are half in each block
+void nttButterflies(void* ctx, int start, int end) {
+    NTTPass* pass = ctx;
+    int half = pass->half;
+    uint32_t p = pass->p;
+    const uint32_t* roots = pass->roots;
+    int j = start % half;
+    uint32_t* x = pass->a + (start - j) * 2, * y = x + half;
+    for(int t = start;t < end;t++) {
+        uint32_t u = x[j], v = (uint64_t)y[j] * roots[j] % p;
+        x[j] = u + v >= p ? u + v - p : u + v;
+        y[j] = u >= v ? u - v : u + p - v;
+        if(++j == half) {
+            j = 0;
+            x += 2 * half;
+            y += 2 * half;
+        }
+    }
+}
+//In place number theoretic transform of length n (power of two) mod p
+void nttTransform(uint32_t* a, int n, uint32_t p, bool inverse, uint32_t* roots) {
+    NTTPass pass = { a,n,1,p,roots };
+    arbParallelFor(n, 1 << 14, &nttBitReverse, &pass);
+    for(int len = 2;len <= n;len <<= 1) {
+        int half = len / 2;
+        uint64_t w = nttPowMod(3, (p - 1) / len, p);
+        if(inverse) w = nttPowMod(w, p - 2, p);
+        roots[0] = 1;
+        for(int j = 1;j < half;j++) roots[j] = roots[j - 1] * w % p;
+        pass.half = half;
+        arbParallelFor(n / 2, 1 << 13, &nttButterflies, &pass);
+    }
+    if(inverse) {
+        uint64_t nInv = nttPowMod(n, p - 2, p);
+        for(int i = 0;i < n;i++) a[i] = a[i] * nInv % p;
+    }
+}
+//The product modulo one of the primes, the three primes are independent
+typedef struct NTTJobStruct {
+    const uint32_t* a;
+    int aLen;
+    const uint32_t* b;
+    int bLen;
+    int n;
+    uint32_t p;
+    uint32_t* residues;
+} NTTJob;
+void nttRunJob(void* arg) {
+    NTTJob* job = arg;
+    int n = job->n;
+    uint32_t p = job->p;
+    bool square = job->a == job->b && job->aLen == job->bLen;
+    long long mark = arbArenaMark();
+    uint32_t* aCoef = job->residues;
+    uint32_t* bCoef = square ? NULL : arbScratch(n);
+    uint32_t* roots = arbScratch(n / 2 + 1);
+    //Reverse digits into little-endian coefficients
+    const uint32_t* factors[2] = { job->a,job->b };
+    uint32_t* coefs[2] = { aCoef,bCoef };
+    int lens[2] = { job->aLen,job->bLen };
+    for(int f = 0;f < 2 - square;f++) {
+        memset(coefs[f], 0, n * sizeof(uint32_t));
+        for(int i = 0;i < lens[f];i++) coefs[f][i] = factors[f][lens[f] - 1 - i] % p;
+    }
+    nttTransform(aCoef, n, p, false, roots);
+    if(square) for(int i = 0;i < n;i++) aCoef[i] = (uint64_t)aCoef[i] * aCoef[i] % p;
+    else {
+        nttTransform(bCoef, n, p, false, roots);
+        for(int i = 0;i < n;i++) aCoef[i] = (uint64_t)aCoef[i] * bCoef[i] % p;
+    }
+    nttTransform(aCoef, n, p, true, roots);
+    arbArenaRelease(mark);
+}
+//The residues of each prime, n apart, and the upper parts of the recombined coefficients
+typedef struct NTTRecombineStruct {
+    uint32_t* residues;
+    int n;
+    uint64_t* rests;
+} NTTRecombine;
+//Garner's algorithm: x = r0 + p0*t1 + p0*p1*t2
+//x = low + rest*2^32, low is stored in place of r0
+void nttRecombine(void* ctx, int start, int end) {
+    NTTRecombine* recombine = ctx;
+    uint32_t* r0s = recombine->residues, * r1s = r0s + recombine->n, * r2s = r1s + recombine->n;
+    uint64_t* rests = recombine->rests;
+    const uint64_t p0 = nttPrimes[0], p1 = nttPrimes[1], p2 = nttPrimes[2];
+    const uint64_t p0Inv = nttPowMod(p0, p1 - 2, p1);
+    const uint64_t p01 = p0 * p1;
+    const uint64_t p01Inv = nttPowMod(p01 % p2, p2 - 2, p2);
+    for(int i = start;i < end;i++) {
+        uint64_t r0 = r0s[i], r1 = r1s[i], r2 = r2s[i];
+        uint64_t t1 = (r1 + p1 - r0 % p1) % p1 * p0Inv % p1;
+        uint64_t x01 = r0 + p0 * t1;
+        uint64_t t2 = (r2 + p2 - x01 % p2) % p2 * p01Inv % p2;
+        //x = x01 + p01*t2
+        uint64_t low = x01 + (p01 & 0xFFFFFFFF) * t2;
+        uint64_t high = (p01 >> 32) * t2;
+        r0s[i] = low;
+        rests[i] = (low >> 32) + high;
+    }
+}
+//nttRecombine for base 10^9 digits: x = d0 + d1*10^9 + d2*10^18, d0 replaces r0 and rest is d1 + d2*2^32
+void nttRecombineDec(void* ctx, int start, int end) {
+    NTTRecombine* recombine = ctx;
+    uint32_t* r0s = recombine->residues, * r1s = r0s + recombine->n, * r2s = r1s + recombine->n;
+    uint64_t* rests = recombine->rests;
+    const uint64_t p0 = nttPrimes[0], p1 = nttPrimes[1], p2 = nttPrimes[2];
+    const uint64_t p0Inv = nttPowMod(p0, p1 - 2, p1);
+    const uint64_t p01 = p0 * p1;
+    const uint64_t p01Inv = nttPowMod(p01 % p2, p2 - 2, p2);
+    const uint64_t pHigh = p01 / ARB_DEC_BASE, pLow = p01 % ARB_DEC_BASE;
+    for(int i = start;i < end;i++) {
+        uint64_t r0 = r0s[i], r1 = r1s[i], r2 = r2s[i];
+        uint64_t t1 = (r1 + p1 - r0 % p1) % p1 * p0Inv % p1;
+        uint64_t x01 = r0 + p0 * t1;
+        uint64_t t2 = (r2 + p2 - x01 % p2) % p2 * p01Inv % p2;
+        //x = x01 + pLow*t2 + pHigh*t2*10^9, neither part overflows
+        uint64_t low = x01 + pLow * t2;
+        uint64_t high = low / ARB_DEC_BASE + pHigh * t2;
+        r0s[i] = low % ARB_DEC_BASE;
+        rests[i] = high % ARB_DEC_BASE | high / ARB_DEC_BASE << 32;
+    }
+}
+//Exact multiplication with three NTT primes, recombined with the chinese remainder theorem
+void digitMultNTT(const uint32_t* a, int aLen, const uint32_t* b, int bLen, uint32_t* out) {
+    nttMultiply(a, aLen, b, bLen, out, false);
+}
+//The NTT product of digits in base 2^32, or 10^9 if decimal
+void nttMultiply(const uint32_t* a, int aLen, const uint32_t* b, int bLen, uint32_t* out, bool decimal) {
+    int n = 1;
+    while(n < aLen + bLen) n <<= 1;
+    long long mark = arbArenaMark();
+    uint32_t* residues = arbScratch(3 * n);
+    uint64_t* rests = (uint64_t*)arbScratch(2 * n);
+    NTTJob jobs[3];
+    for(int prime = 0;prime < 3;prime++) {
+        NTTJob job = { a,aLen,b,bLen,n,nttPrimes[prime],residues + prime * n };
+        jobs[prime] = job;
+    }
+    arbRunAll(&nttRunJob, jobs, sizeof(NTTJob), 3, arbUseThreads(bLen));
+    int outLen = aLen + bLen;
+    NTTRecombine recombine = { residues,n,rests };
+    arbParallelFor(outLen, 1 << 14, decimal ? &nttRecombineDec : &nttRecombine, &recombine);
+    //Carry into big-endian digits, each x spans three digits
+    uint64_t carry = 0;
+    for(int i = 0;i < outLen;i++) {
+        uint64_t new = residues[i] + carry;
+        if(i >= 1) new += rests[i - 1] & 0xFFFFFFFF;
+        if(i >= 2) new += rests[i - 2] >> 32;
+        if(decimal) {
+            carry = new / ARB_DEC_BASE;
+            out[outLen - 1 - i] = new % ARB_DEC_BASE;
+        }
+        else {
+            carry = new >> 32;
+            out[outLen - 1 - i] = new;
+        }
+    }
+    arbArenaRelease(mark);
+}
+void digitMult(const uint32_t* a, int aLen, const uint32_t* b, int bLen, uint32_t* out) {
+    if(aLen < bLen) {
+        const uint32_t* tmp = a;
+        a = b;
+        b = tmp;
+        int tmpLen = aLen;
+        aLen = bLen;
+        bLen = tmpLen;
     }
-    //Set factors
+    if(bLen == 0) {
+        memset(out, 0, aLen * sizeof(uint32_t));
+        return;
+    }
+    if(bLen == 1) {
+        digitMultDigit(a, aLen, b[0], out);
+        return;
+    }
+    if(aLen == bLen && aLen <= ARB_FIXED_MAX) {
+        digitMultFixed[aLen](a, b, out);
+        return;
+    }
+    if(bLen < karatsubaThreshold) {
+        digitMultSchool(a, aLen, b, bLen, out);
+        return;
+    }
+    //The NTT handles unbalanced factors, but is limited by the largest power of two that divides p-1
+    if(bLen >= nttThreshold && aLen + bLen <= nttMaxDigits) {
+        digitMultNTT(a, aLen, b, bLen, out);
+        return;
+    }
+    //Unbalanced factors are split into bLen sized chunks of a
+    if(bLen <= (aLen + 1) / 2) {
+        int outLen = aLen + bLen;
+        long long mark = arbArenaMark();
+        uint32_t* chunk = arbScratch(bLen * 2);
+        memset(out, 0, outLen * sizeof(uint32_t));
+        int pos = aLen;
+        while(pos > 0) {
+            int len = pos < bLen ? pos : bLen;
+            digitMult(a + pos - len, len, b, bLen, chunk);
+            digitAddInto(out, outLen - (aLen - pos), chunk, len + bLen);
+            pos -= len;
+        }
+        arbArenaRelease(mark);
+        return;
+    }
+    if(bLen < toomThreshold || bLen <= 2 * ((aLen + 2) / 3)) digitMultKaratsuba(a, aLen, b, bLen, out);
+    else digitMultToom3(a, aLen, b, bLen, out);
+}
+#pragma endregion
+Arb arb_mult(Arb one, Arb two) {
     Arb out;
     out.accu = one.accu > two.accu ? one.accu : two.accu;
-    out.len = one.len + two.len + 1;
-    if(out.len > out.accu) out.len = out.accu + 1;
-    long mantissaOut[out.len + 8];
-    memset(mantissaOut, 0, (out.len + 8) * sizeof(long));
-    out.exp = one.exp + two.exp;
+    out.len = one.len + two.len;
+    //Leave room for trimZeroes to read the rounding digit
+    out.mantissa = arbAlloc(out.len + 1);
+    out.exp = one.exp + two.exp + 1;
     out.sign = one.sign ^ two.sign;
-    int i, j;
-    //Multiply
-    for(i = 0;i < one.len;i++) {
-        long* m;
-        m = mantissaOut + i;
-        long oneVal = one.mantissa[i];
-        int count = out.len - i - 1;
-        for(j = 0;j < count;j++) m[j] += oneVal * two.mantissa[j];
-    }
-    //Carry overflow
-    i = out.len;
-    while(--i >= 1) {
-        if(mantissaOut[i] > 255) {
-            mantissaOut[i - 1] += mantissaOut[i] / 256;
-            mantissaOut[i] %= 256;
-        }
-    }
-    while(mantissaOut[0] > 255) {
-        if(out.len == out.accu) out.len--;
-        memmove(mantissaOut + 1, mantissaOut, out.len);
-        mantissaOut[0] = mantissaOut[1] / 256;
-        mantissaOut[1] %= 256;
-        out.len++;
-        out.exp++;
-    }
-    //Copy cells
-    unsigned char* mant = calloc(out.len, 1);
-    //Memcpy cannot be used here because mantissaOut is a long*
-    for(int i = 0;i < out.len;i++) mant[i] = mantissaOut[i];
-    out.mantissa = mant;
-    out.len--;
+    digitMult(one.mantissa, one.len, two.mantissa, two.len, out.mantissa);
     trimZeroes(&out);
-    //Return
     return out;
-    //https://en.wikipedia.org/wiki/Karatsuba_algorithm if greater than 1000
-    /*
-        (az+b)*(cz+d)
-
-        Calculate ac, bd, (a+b)(c+d)
-        return ac*z^2 + ((a+b)*(c+d) - ac - bd)z + bd
-        = a*c*z^2 + bcz + adz + bd
-
-    */
-
+}
+void arb_mult_into(Arb* dst, Arb one, Arb two) {
+    //The full product is built on the stack or in the arena, then rounded into dst
+    long long mark = arbArenaMark();
+    int len = one.len + two.len;
+    uint32_t stackProduct[2 * ARB_FIXED_MAX];
+    uint32_t* product = len <= 2 * ARB_FIXED_MAX ? stackProduct : arbScratch(len);
+    digitMult(one.mantissa, one.len, two.mantissa, two.len, product);
+    dst->len = len > dst->accu + 1 ? dst->accu + 1 : len;
+    memcpy(dst->mantissa, product, dst->len * sizeof(uint32_t));
+    dst->mantissa[dst->len] = 0;
+    arbArenaRelease(mark);
+    dst->exp = one.exp + two.exp + 1;
+    dst->sign = one.sign ^ two.sign;
+    trimZeroes(dst);
+}
+void arb_set_into(Arb* dst, Arb src) {
+    if(arbIsZero(src)) {
+        dst->len = 1;
+        dst->mantissa[0] = 0;
+        dst->exp = 0;
+        dst->sign = 0;
+        return;
+    }
+    dst->len = src.len > dst->accu + 1 ? dst->accu + 1 : src.len;
+    memmove(dst->mantissa, src.mantissa, dst->len * sizeof(uint32_t));
+    dst->mantissa[dst->len] = 0;
+    dst->exp = src.exp;
+    dst->sign = src.sign;
+    trimZeroes(dst);
 }
 Arb arb_recip(Arb one) {
     /*
         To find the reciprocal of one:
-        Start with an initial approximation to find x[0]
+        Start with a double precision approximation x[0] (about one and a half digits)
         Then use this iteration sequence
+        x[n+1] = x[n] + x[n] * (1 - one*x[n])
 
-
-        When the exponent 1-D*x[n] is less than accu, the result has been reached.
-
-        x[INF] is exactly equal to the reciprocal
-
+        Each step doubles the number of correct digits,
+        so each step only needs to work at twice the accuracy of the previous one.
+        The total cost is a small multiple of one multiplication at full accuracy.
     */
-    //Generate an approximation (about one digit of accuracy.
     char sign = one.sign;
+    int exp = one.exp;
+    int target = one.accu + 2;
+    //Scale one to 1 <= one < 2^32
     one.sign = 0;
-    one.accu += 4;
-    Arb approx = arbCTR(calloc(1, 1), 1, -one.exp - 1, 0, one.accu);
-    approx.mantissa[0] = 255 / one.mantissa[0];
-    Arb error;
-    error.exp = one.exp;
-    //x[n+1] = x[n] + x[n] * (1 - one*x[n])
-    while(error.exp > one.exp - one.accu) {
-        error = arb_mult(one, approx);
-        //If error will equal zero
-        if(error.len == 1 && error.exp == 0) {
-            if(error.mantissa[0] == 1) {
-                freeArb(error);
-                break;
-            }
-        }
-        //1-error
-        if(error.exp == 0) {
-            error.mantissa[0] -= 1;
-            error.sign = 1;
-        }
-        else {
-            if(error.exp < -1) arbRightShift(&error, -error.exp - 1);
-            int i = 0;
-            for(i = 0;i < error.len;i++) error.mantissa[i] = 255 - error.mantissa[i];
-            error.mantissa[i - 1] += 1;
-            error.sign = 0;
-        }
-        trimZeroes(&error);
-        // Calculate approx + approx*error
-        Arb tmp = arb_mult(approx, error);
-        Arb tmp2 = arb_add(approx, tmp);
-        freeArb(tmp);
-        freeArb(approx);
-        approx = tmp2;
-        freeArb(error);
-    }
-    one.sign = sign;
-    one.accu -= 4;
-    approx.accu -= 4;
+    one.exp = 0;
+    //The iteration reuses these buffers, growing accu up to the target
+    //Small reciprocals keep them on the stack
+    bool onStack = target <= ARB_FIXED_MAX;
+    uint32_t stackDigits[4][ARB_FIXED_MAX + 4];
+    Arb approx = onStack ? arbCTR(stackDigits[0], 1, 0, 0, target + 2) : arbBuffer(target + 2);
+    Arb x = onStack ? arbCTR(stackDigits[1], 1, 0, 0, target + 2) : arbBuffer(target + 2);
+    Arb error = onStack ? arbCTR(stackDigits[2], 1, 0, 0, target + 2) : arbBuffer(target + 2);
+    Arb correction = onStack ? arbCTR(stackDigits[3], 1, 0, 0, target + 2) : arbBuffer(target + 2);
+    uint32_t oneDigits[2] = { 1,0 };
+    Arb oneArb = arbCTR(oneDigits, 1, 0, 0, 1);
+    //The seed is rounded to two digits
+    approx.accu = 2;
+    doubleToArb_into(&approx, 1.0 / arbToDouble(one));
+    int prec = 1;
+    while(prec < target) {
+        int prevPrec = prec;
+        prec = prec * 2 > target ? target : prec * 2;
+        int work = prec + 2;
+        //1 - one*x[n] at the new accuracy
+        x.accu = work;
+        approx.accu = work;
+        error.accu = work;
+        correction.accu = work;
+        arb_set_into(&x, one);
+        arb_mult_into(&error, x, approx);
+        arb_subtract_into(&error, oneArb, error);
+        //The error is about B^-prevPrec, so the correction only needs the leading digits of x[n]
+        x.accu = work - prevPrec + 1;
+        arb_set_into(&x, approx);
+        arb_mult_into(&correction, x, error);
+        arb_add_into(&approx, approx, correction);
+    }
+    approx.exp -= exp;
     approx.sign = sign;
+    if(onStack) return arbWithAccu(approx, target - 2);
+    freeArb(x);
+    freeArb(error);
+    freeArb(correction);
+    approx.accu = target - 2;
     trimZeroes(&approx);
     return approx;
 }
-Arb arb_pi(int accu) {
-    const unsigned char piStart[] = { 36,67,63,246,106,168,136,136,133,90,163,48,8,141,211,49,19,49,25,152,138,162,46,224,3,55,112,7,115,52,68,74,164,64,9,147,56,130,34,34,41,153,159,243,49,29 };
+Arb arb_divide(Arb one, Arb two) {
+    if(two.len == 1 && two.mantissa[0] == 0) {
+        error("Division by zero");
+        return intToArb(0, one.accu);
+    }
+    if(two.accu < one.accu) two.accu = one.accu;
+    Arb recip = arb_recip(two);
+    Arb out = arb_mult(one, recip);
+    freeArb(recip);
+    return out;
+}
+#pragma region Transcendental Functions
+//Returns 2^power
+Arb arbPow2(int power, int accu) {
+    Arb out = arbCTR(arbAlloc(1), 1, power >> 5, 0, accu);
+    out.mantissa[0] = 1u << (power & 31);
+    return out;
+}
+//Number of bits in the integer part of one, negative if one is less than 1/2
+int arbIntBits(Arb one) {
+    int bits = 0;
+    while(bits < 32 && (one.mantissa[0] >> bits) != 0) bits++;
+    return one.exp * 32 + bits;
+}
+/*
+    Binary splitting of a series for terms a to b-1, where the kth term is the k-1th term times r/q(k)
+    q(k) = k gives the exp series r^k/k!, and q(k) = 2k(2k+1) with r = -x^2 gives the series of sin(x)/x
+    P = r^(b-a), Q = q(a)*q(a+1)*...*q(b-1), and T/Q is the sum of the terms over the range divided by the a-1th term
+*/
+void seriesSplit(Arb r, int a, int b, int accu, bool odd, bool needP, Arb* P, Arb* Q, Arb* T) {
+    if(b - a == 1) {
+        *Q = intToArb(odd ? 2LL * a * (2 * a + 1) : a, accu);
+        *T = arbWithAccu(r, accu);
+        if(needP) *P = arbWithAccu(r, accu);
+        return;
+    }
+    int m = (a + b) / 2;
+    Arb P1, Q1, T1, P2, Q2, T2;
+    seriesSplit(r, a, m, accu, odd, true, &P1, &Q1, &T1);
+    seriesSplit(r, m, b, accu, odd, needP, &P2, &Q2, &T2);
+    //T = T1*Q2 + P1*T2
+    Arb left = arb_mult(T1, Q2);
+    Arb right = arb_mult(P1, T2);
+    *T = arb_add(left, right);
+    *Q = arb_mult(Q1, Q2);
+    if(needP) {
+        *P = arb_mult(P1, P2);
+        freeArb(P2);
+    }
+    freeArb(left);
+    freeArb(right);
+    freeArb(P1);
+    freeArb(Q1);
+    freeArb(T1);
+    freeArb(Q2);
+    freeArb(T2);
+}
+//exp(r) for 0 <= r < 1 using binary splitting, cheap when r has few digits
+Arb expSeries(Arb r, int accu) {
+    if(r.len == 1 && r.mantissa[0] == 0) return intToArb(1, accu);
+    //Find the number of terms where r^k/k! drops below 2^(-32*accu)
+    double logR = 32.0 * r.exp + log2(r.mantissa[0] + 1.0);
+    double logTerm = 0;
+    int terms = 0;
+    while(logTerm > -32.0 * accu) {
+        terms++;
+        logTerm += logR - log2(terms);
+    }
+    Arb P, Q, T;
+    seriesSplit(r, 1, terms + 1, accu, false, false, &P, &Q, &T);
+    //exp(r) = 1 + T/Q
+    Arb sum = arb_add(Q, T);
+    Arb out = arb_divide(sum, Q);
+    freeArb(sum);
+    freeArb(Q);
+    freeArb(T);
+    return out;
+}
+//Returns the digits lo to hi after the point of r (0 < r < 1), for the bit-burst algorithm
+Arb arbChunk(Arb r, int lo, int hi, int accu) {
+    Arb chunk = arbCTR(arbAlloc(hi - lo + 2), hi - lo + 1, -lo, 0, accu);
+    for(int pos = lo;pos <= hi;pos++) {
+        int i = pos + r.exp;
+        if(i >= 0 && i < r.len) chunk.mantissa[pos - lo] = r.mantissa[i];
+    }
+    trimZeroes(&chunk);
+    return chunk;
+}
+Arb arb_exp(Arb one) {
+    int accu = one.accu;
+    if(one.len == 1 && one.mantissa[0] == 0) return intToArb(1, accu);
+    //Results must fit within the exponent range
+    if(fabs(arbToDouble(one)) > ARB_MAX_EXP * 32.0 * log(2)) {
+        error("Overflow in exp");
+        return intToArb(0, accu);
+    }
+    char sign = one.sign;
+    //Reduce one to below 2^-8 so the first chunk of the series converges quickly, then square the result back
+    int squarings = arbIntBits(one) + 8;
+    if(squarings < 0) squarings = 0;
+    int workAccu = accu + 2 + squarings / 32;
+    Arb scale = arbPow2(-squarings, workAccu);
+    one.sign = 0;
+    Arb reduced = arb_mult(one, scale);
+    freeArb(scale);
+    reduced.accu = workAccu;
+    trimZeroes(&reduced);
+    /*
+        Bit-burst algorithm: split reduced into chunks r0 + r1 + r2 ... where r[j] holds the digits 2^(j-1)+1 to 2^j after the point.
+        exp(reduced) is the product of exp(r[j]), and every chunk has about as many digits as leading zeroes,
+        so each series is short or has small terms.
+    */
+    Arb out = intToArb(1, workAccu);
+    int lastPos = reduced.len - 1 - reduced.exp;
+    for(int lo = 1, hi = 1;lo <= lastPos;lo = hi + 1, hi *= 2) {
+        if(hi > lastPos) hi = lastPos;
+        Arb chunk = arbChunk(reduced, lo, hi, workAccu);
+        if(chunk.len != 1 || chunk.mantissa[0] != 0) {
+            Arb term = expSeries(chunk, workAccu);
+            Arb product = arb_mult(out, term);
+            freeArb(out);
+            freeArb(term);
+            out = product;
+        }
+        freeArb(chunk);
+    }
+    freeArb(reduced);
+    for(int i = 0;i < squarings;i++) {
+        Arb square = arb_mult(out, out);
+        freeArb(out);
+        out = square;
+    }
+    if(sign == 1) {
+        Arb recip = arb_recip(out);
+        freeArb(out);
+        out = recip;
+    }
+    out.accu = accu;
+    trimZeroes(&out);
+    return out;
+}
+//ln(one) for one >= 1 by Newton's method on exp with precision doubling
+Arb lnNewton(Arb one, int accu) {
+    Arb y = doubleToArb(log(arbToDouble(one)), accu);
+    int prec = 1;
+    bool finished = false;
+    while(!finished) {
+        if(prec >= accu) {
+            prec = accu;
+            finished = true;
+        }
+        else prec *= 2;
+        //y = y + one*exp(-y) - 1
+        y.accu = prec + 1;
+        y.sign ^= 1;
+        Arb expY = arb_exp(y);
+        y.sign ^= 1;
+        Arb x = arbWithAccu(one, prec + 1);
+        Arb product = arb_mult(x, expY);
+        Arb oneArb = intToArb(1, prec + 1);
+        Arb correction = arb_subtract(product, oneArb);
+        Arb newY = arb_add(y, correction);
+        freeArb(y);
+        freeArb(expY);
+        freeArb(x);
+        freeArb(product);
+        freeArb(oneArb);
+        freeArb(correction);
+        y = newY;
+    }
+    y.accu = accu;
+    trimZeroes(&y);
+    return y;
+}
+Arb arb_ln(Arb one) {
+    int accu = one.accu;
+    if(one.len == 1 && one.mantissa[0] == 0) {
+        error("Logarithm of zero");
+        return intToArb(0, accu);
+    }
+    one.sign = 0;
+    //Extra digits to make up for cancellation when one is close to 1
+    int guard = 0;
+    Arb oneArb = intToArb(1, accu);
+    Arb diff = arb_subtract(one, oneArb);
+    if(diff.exp < 0 && (diff.len != 1 || diff.mantissa[0] != 0)) guard = -diff.exp;
+    freeArb(diff);
+    freeArb(oneArb);
+    int workAccu = accu + 2 + guard;
+    //ln(one) = ln(mantissa) + exp*32*ln(2)
+    int exp = one.exp;
+    one.exp = 0;
+    Arb mantissa = arbWithAccu(one, workAccu);
+    Arb out = lnNewton(mantissa, workAccu);
+    freeArb(mantissa);
+    if(exp != 0) {
+        Arb ln2 = getArbConstant(arbconst_ln2, workAccu);
+        Arb bits = intToArb(exp * 32LL, workAccu);
+        Arb offset = arb_mult(ln2, bits);
+        freeArb(bits);
+        Arb sum = arb_add(out, offset);
+        freeArb(ln2);
+        freeArb(offset);
+        freeArb(out);
+        out = sum;
+    }
+    out.accu = accu;
+    trimZeroes(&out);
+    return out;
+}
+Arb arb_pow(Arb one, Arb two) {
+    int accu = one.accu > two.accu ? one.accu : two.accu;
+    bool baseIsZero = one.len == 1 && one.mantissa[0] == 0;
+    if(two.len == 1 && two.mantissa[0] == 0) return intToArb(1, accu);
+    if(baseIsZero) {
+        if(two.sign == 1) error("Division by zero");
+        return intToArb(0, accu);
+    }
+    //Integer powers use repeated squaring, and are valid for negative bases
+    if(two.exp == 0 && two.len == 1) {
+        uint32_t power = two.mantissa[0];
+        int workAccu = accu + 2;
+        Arb square = arbWithAccu(one, workAccu);
+        Arb out = intToArb(1, workAccu);
+        while(power != 0) {
+            if(power & 1) {
+                Arb product = arb_mult(out, square);
+                freeArb(out);
+                out = product;
+            }
+            power >>= 1;
+            if(power != 0) {
+                Arb newSquare = arb_mult(square, square);
+                freeArb(square);
+                square = newSquare;
+            }
+        }
+        freeArb(square);
+        if(two.sign == 1) {
+            Arb recip = arb_recip(out);
+            freeArb(out);
+            out = recip;
+        }
+        out.accu = accu;
+        trimZeroes(&out);
+        return out;
+    }
+    //one^0.5
+    if(two.sign == 0 && two.exp == -1 && two.len == 1 && two.mantissa[0] == 0x80000000) {
+        Arb base = arbWithAccu(one, accu);
+        Arb out = arb_sqrt(base);
+        freeArb(base);
+        return out;
+    }
+    if(one.sign == 1) {
+        error("Negative base with a fractional power");
+        return intToArb(0, accu);
+    }
+    //exp(two*ln(one)), with extra digits for the integer part of the product
+    double magnitude = fabs(arbToDouble(two)) * (fabs(log(one.mantissa[0])) + 32 * log(2) * abs(one.exp) + 1);
+    int workAccu = accu + 2 + (magnitude > 1 ? (int)(log2(magnitude) / 32) + 1 : 0);
+    Arb base = arbWithAccu(one, workAccu);
+    Arb lnBase = arb_ln(base);
+    Arb product = arb_mult(lnBase, two);
+    Arb out = arb_exp(product);
+    freeArb(base);
+    freeArb(lnBase);
+    freeArb(product);
+    out.accu = accu;
+    trimZeroes(&out);
+    return out;
+}
+Arb arb_sinh(Arb one) {
+    int accu = one.accu;
+    if(one.len == 1 && one.mantissa[0] == 0) return intToArb(0, accu);
+    //exp(one) and exp(-one) cancel when one is small
+    int workAccu = accu + 2 + (one.exp < 0 ? -one.exp : 0);
+    one.accu = workAccu;
+    Arb exp = arb_exp(one);
+    Arb recip = arb_recip(exp);
+    Arb diff = arb_subtract(exp, recip);
+    //Divide by two
+    Arb half = arbPow2(-1, workAccu);
+    Arb out = arb_mult(diff, half);
+    freeArb(exp);
+    freeArb(recip);
+    freeArb(diff);
+    freeArb(half);
+    out.accu = accu;
+    trimZeroes(&out);
+    return out;
+}
+//sin(x) for 0 <= x < 1 using binary splitting, cheap when x has few digits
+Arb sinSeries(Arb x, int accu) {
+    if(x.len == 1 && x.mantissa[0] == 0) return intToArb(0, accu);
+    //Find the number of terms where x^(2k+1)/(2k+1)! drops below 2^(-32*accu)
+    double logX = 32.0 * x.exp + log2(x.mantissa[0] + 1.0);
+    double logTerm = 0;
+    int terms = 0;
+    while(logTerm > -32.0 * accu) {
+        terms++;
+        logTerm += 2 * logX - log2(2.0 * terms) - log2(2.0 * terms + 1);
+    }
+    Arb square = arb_mult(x, x);
+    square.sign = 1;
+    Arb P, Q, T;
+    seriesSplit(square, 1, terms + 1, accu, true, false, &P, &Q, &T);
+    //sin(x) = x * (1 + T/Q)
+    Arb sum = arb_add(Q, T);
+    Arb ratio = arb_divide(sum, Q);
+    Arb out = arb_mult(x, ratio);
+    freeArb(square);
+    freeArb(sum);
+    freeArb(ratio);
+    freeArb(Q);
+    freeArb(T);
+    out.accu = accu;
+    trimZeroes(&out);
+    return out;
+}
+void arbSinCos(Arb one, Arb* sinOut, Arb* cosOut) {
+    int accu = one.accu;
+    int workAccu = accu + 2;
+    //Reduce one to r = one - k*pi/2 where |r| <= pi/4, which needs pi to the last digit of one
+    int quadrant = 0;
+    Arb r;
+    if(fabs(arbToDouble(one)) < 0.78) r = arbWithAccu(one, workAccu);
+    else {
+        int reduceAccu = workAccu + (one.exp > 0 ? one.exp + 1 : 0);
+        Arb pi = getArbConstant(arbconst_pi, reduceAccu);
+        Arb half = arbPow2(-1, reduceAccu);
+        Arb halfPi = arb_mult(pi, half);
+        Arb x = arbWithAccu(one, reduceAccu);
+        Arb quotient = arb_divide(x, halfPi);
+        //Round to the nearest integer, arb_floor rounds toward zero
+        char quotientSign = quotient.sign;
+        quotient.sign = 0;
+        Arb rounded = arb_add(quotient, half);
+        Arb k = arb_floor(rounded);
+        if(!arbIsZero(k)) k.sign = quotientSign;
+        Arb multiple = arb_mult(k, halfPi);
+        r = arb_subtract(x, multiple);
+        //k mod 4, from the ones digit of k
+        if(k.exp >= 0 && k.exp < k.len) quadrant = k.mantissa[k.exp] & 3;
+        if(k.sign == 1) quadrant = (4 - quadrant) & 3;
+        freeArb(pi);
+        freeArb(half);
+        freeArb(halfPi);
+        freeArb(x);
+        freeArb(quotient);
+        freeArb(rounded);
+        freeArb(k);
+        freeArb(multiple);
+        r.accu = workAccu;
+        trimZeroes(&r);
+    }
+    char sign = r.sign;
+    r.sign = 0;
+    //Bit-burst algorithm as in arb_exp, with the angle addition formulas to combine the chunks
+    Arb c = intToArb(1, workAccu);
+    Arb s = intToArb(0, workAccu);
+    Arb oneArb = intToArb(1, workAccu);
+    int lastPos = r.len - 1 - r.exp;
+    for(int lo = 1, hi = 1;lo <= lastPos;lo = hi + 1, hi *= 2) {
+        if(hi > lastPos) hi = lastPos;
+        Arb chunk = arbChunk(r, lo, hi, workAccu);
+        if(chunk.len != 1 || chunk.mantissa[0] != 0) {
+            //Every chunk is below pi/4, so its cosine is positive and not close to zero
+            Arb chunkSin = sinSeries(chunk, workAccu);
+            Arb sinSquare = arb_mult(chunkSin, chunkSin);
+            Arb cosSquare = arb_subtract(oneArb, sinSquare);
+            Arb chunkCos = arb_sqrt(cosSquare);
+            //cos(a+b) = cos(a)cos(b) - sin(a)sin(b), sin(a+b) = sin(a)cos(b) + cos(a)sin(b)
+            Arb cc = arb_mult(c, chunkCos);
+            Arb ss = arb_mult(s, chunkSin);
+            Arb sc = arb_mult(s, chunkCos);
+            Arb cs = arb_mult(c, chunkSin);
+            freeArb(c);
+            freeArb(s);
+            c = arb_subtract(cc, ss);
+            s = arb_add(sc, cs);
+            freeArb(chunkSin);
+            freeArb(sinSquare);
+            freeArb(cosSquare);
+            freeArb(chunkCos);
+            freeArb(cc);
+            freeArb(ss);
+            freeArb(sc);
+            freeArb(cs);
+        }
+        freeArb(chunk);
+    }
+    freeArb(r);
+    freeArb(oneArb);
+    if(sign == 1 && !arbIsZero(s)) s.sign ^= 1;
+    //sin and cos of one are +-s and +-c depending on the quadrant
+    Arb sinResult = quadrant % 2 == 0 ? s : c;
+    Arb cosResult = quadrant % 2 == 0 ? c : s;
+    if((quadrant == 2 || quadrant == 3) && !arbIsZero(sinResult)) sinResult.sign ^= 1;
+    if((quadrant == 1 || quadrant == 2) && !arbIsZero(cosResult)) cosResult.sign ^= 1;
+    sinResult.accu = cosResult.accu = accu;
+    trimZeroes(&sinResult);
+    trimZeroes(&cosResult);
+    if(sinOut != NULL) *sinOut = sinResult;
+    else freeArb(sinResult);
+    if(cosOut != NULL) *cosOut = cosResult;
+    else freeArb(cosResult);
+}
+Arb arb_sin(Arb one) {
+    Arb out;
+    arbSinCos(one, &out, NULL);
+    return out;
+}
+Arb arb_cos(Arb one) {
     Arb out;
+    arbSinCos(one, NULL, &out);
+    return out;
+}
+Arb arb_tan(Arb one) {
+    Arb sin, cos;
+    arbSinCos(one, &sin, &cos);
+    Arb out = arb_divide(sin, cos);
+    freeArb(sin);
+    freeArb(cos);
+    return out;
+}
+Arb arb_atan(Arb one) {
+    int accu = one.accu;
+    if(one.len == 1 && one.mantissa[0] == 0) return intToArb(0, accu);
+    /*
+        Newton's method on tan with precision doubling, using
+        y = y + tan(atan(one) - y) = y + (one*cos(y) - sin(y)) / (cos(y) + one*sin(y))
+    */
+    Arb y = doubleToArb(atan(arbToDouble(one)), accu + 1);
+    int prec = 1;
+    bool finished = false;
+    while(!finished) {
+        if(prec >= accu) {
+            prec = accu;
+            finished = true;
+        }
+        else prec *= 2;
+        y.accu = prec + 1;
+        Arb sin, cos;
+        arbSinCos(y, &sin, &cos);
+        Arb x = arbWithAccu(one, prec + 1);
+        Arb xCos = arb_mult(x, cos);
+        Arb xSin = arb_mult(x, sin);
+        Arb numerator = arb_subtract(xCos, sin);
+        Arb denominator = arb_add(cos, xSin);
+        Arb correction = arb_divide(numerator, denominator);
+        Arb newY = arb_add(y, correction);
+        freeArb(y);
+        freeArb(sin);
+        freeArb(cos);
+        freeArb(x);
+        freeArb(xCos);
+        freeArb(xSin);
+        freeArb(numerator);
+        freeArb(denominator);
+        freeArb(correction);
+        y = newY;
+    }
+    y.accu = accu;
+    trimZeroes(&y);
+    return y;
+}
+//asin(one) = atan(one/sqrt((1-one)(1+one))), with the product form to keep digits near 1
+Arb arb_asin(Arb one) {
+    int accu = one.accu;
+    Arb oneArb = intToArb(1, accu + 1);
+    int cmp = arbCmp(one, oneArb);
+    if(cmp >= 0) {
+        freeArb(oneArb);
+        if(cmp > 0) {
+            error("asin of a number outside of [-1, 1]");
+            return intToArb(0, accu);
+        }
+        //asin(+-1) = +-pi/2
+        Arb pi = getArbConstant(arbconst_pi, accu);
+        Arb out = arbDivInt(pi, 2);
+        out.sign = one.sign;
+        freeArb(pi);
+        return out;
+    }
+    Arb x = arbWithAccu(one, accu + 1);
+    Arb below = arb_subtract(oneArb, x);
+    Arb above = arb_add(oneArb, x);
+    Arb product = arb_mult(below, above);
+    Arb root = arb_sqrt(product);
+    Arb ratio = arb_divide(x, root);
+    Arb out = arb_atan(ratio);
+    freeArb(oneArb);
+    freeArb(x);
+    freeArb(below);
+    freeArb(above);
+    freeArb(product);
+    freeArb(root);
+    freeArb(ratio);
     out.accu = accu;
-    out.len = accu;
-    out.exp = 0;
-    out.mantissa = calloc(out.len, 1);
-    out.sign = 0;
-    out.mantissa[0] = 3;
-    int i;
-    int maxLen = out.len;
-    if(maxLen > 46) maxLen = 46;
-    for(i = 1;i < maxLen;i++) {
-        out.mantissa[i] = piStart[i - 1];
+    trimZeroes(&out);
+    return out;
+}
+//acos(one) = 2*atan(sqrt((1-one)/(1+one))), which has no cancellation near 1
+Arb arb_acos(Arb one) {
+    int accu = one.accu;
+    Arb oneArb = intToArb(1, accu + 1);
+    if(arbCmp(one, oneArb) > 0) {
+        freeArb(oneArb);
+        error("acos of a number outside of [-1, 1]");
+        return intToArb(0, accu);
+    }
+    Arb x = arbWithAccu(one, accu + 1);
+    Arb above = arb_add(oneArb, x);
+    if(arbIsZero(above)) {
+        //acos(-1) = pi
+        freeArb(oneArb);
+        freeArb(x);
+        freeArb(above);
+        return getArbConstant(arbconst_pi, accu);
+    }
+    Arb below = arb_subtract(oneArb, x);
+    Arb ratio = arb_divide(below, above);
+    Arb root = arb_sqrt(ratio);
+    Arb angle = arb_atan(root);
+    Arb out = arb_add(angle, angle);
+    freeArb(oneArb);
+    freeArb(x);
+    freeArb(above);
+    freeArb(below);
+    freeArb(ratio);
+    freeArb(root);
+    freeArb(angle);
+    out.accu = accu;
+    trimZeroes(&out);
+    return out;
+}
+//Returns one^(-1/n) for one > 0 to accu digits
+Arb arbInvRoot(Arb one, int n, int accu) {
+    //one = m*B^(n*k) where 0 <= m.exp < n, so m^(-1/n) is between 1/B and 1
+    int k = one.exp >= 0 ? one.exp / n : -((n - 1 - one.exp) / n);
+    one.exp -= n * k;
+    Arb lead = one;
+    lead.exp = 0;
+    double lnM = log(arbToDouble(lead)) + 32 * log(2) * one.exp;
+    /*
+        y[n+1] = y[n] + y[n] * (1 - m*y[n]^n) / n
+        Like arb_recip, each step doubles the correct digits, so it only works at twice the previous accuracy
+    */
+    Arb seed = doubleToArb(exp(-lnM / n), 2);
+    int target = accu + 2;
+    Arb y = arbBuffer(target + 2);
+    Arb x = arbBuffer(target + 2);
+    Arb power = arbBuffer(target + 2);
+    Arb error = arbBuffer(target + 2);
+    Arb oneArb = intToArb(1, 1);
+    arb_set_into(&y, seed);
+    freeArb(seed);
+    int prec = 1;
+    while(prec < target) {
+        int prevPrec = prec;
+        prec = prec * 2 > target ? target : prec * 2;
+        int work = prec + 2;
+        y.accu = work;
+        x.accu = work;
+        power.accu = work;
+        error.accu = work;
+        //m*y[n]^n by repeated squaring
+        arb_set_into(&x, y);
+        arb_set_into(&power, oneArb);
+        int topBit = 0;
+        while(n >> topBit > 1) topBit++;
+        for(int bit = topBit;bit >= 0;bit--) {
+            arb_mult_into(&power, power, power);
+            if(n >> bit & 1) arb_mult_into(&power, power, x);
+        }
+        arb_set_into(&x, one);
+        arb_mult_into(&error, x, power);
+        arb_subtract_into(&error, oneArb, error);
+        //The error is about B^-prevPrec, so the correction only needs the leading digits of y[n]
+        x.accu = work - prevPrec + 1;
+        arb_set_into(&x, y);
+        arb_mult_into(&power, x, error);
+        Arb scaled = arbDivInt(power, n);
+        arb_add_into(&y, y, scaled);
+        freeArb(scaled);
+    }
+    freeArb(x);
+    freeArb(power);
+    freeArb(error);
+    freeArb(oneArb);
+    y.exp -= k;
+    y.accu = accu;
+    trimZeroes(&y);
+    return y;
+}
+Arb arb_root(Arb one, int n) {
+    int accu = one.accu;
+    if(one.len == 1 && one.mantissa[0] == 0) return intToArb(0, accu);
+    char sign = one.sign;
+    if(sign == 1 && n % 2 == 0) {
+        error("Even root of a negative number");
+        return intToArb(0, accu);
+    }
+    one.sign = 0;
+    Arb invRoot = arbInvRoot(one, n, accu + 1);
+    Arb out;
+    //sqrt(one) = one * one^(-1/2), which avoids a division
+    if(n == 2) out = arb_mult(one, invRoot);
+    else out = arb_recip(invRoot);
+    freeArb(invRoot);
+    out.sign = sign;
+    out.accu = accu;
+    trimZeroes(&out);
+    return out;
+}
+Arb arb_sqrt(Arb one) {
+    return arb_root(one, 2);
+}
+//Returns the product of the integers lo to hi-1 with a balanced product tree, exact when it fits in accu digits
+Arb arbProductRange(uint64_t lo, uint64_t hi, int accu) {
+    //Empty ranges, like the factors of 0! and 1!
+    if(hi <= lo) return intToArb(1, accu);
+    if(hi - lo <= 16) {
+        //Multiply runs of small factors in 64 bits before going to Arb multiplication
+        Arb out = intToArb(1, accu);
+        uint64_t run = 1;
+        for(uint64_t i = lo;i <= hi;i++) {
+            if(i != hi && run <= INT64_MAX / i) {
+                run *= i;
+                continue;
+            }
+            Arb factor = intToArb(run, accu);
+            Arb product = arb_mult(out, factor);
+            freeArb(out);
+            freeArb(factor);
+            out = product;
+            run = i;
+        }
+        return out;
+    }
+    uint64_t mid = lo + (hi - lo) / 2;
+    Arb left = arbProductRange(lo, mid, accu);
+    Arb right = arbProductRange(mid, hi, accu);
+    Arb out = arb_mult(left, right);
+    freeArb(left);
+    freeArb(right);
+    return out;
+}
+/*
+    Spouge's approximation of gamma(w+1) for w >= -1/2
+    gamma(w+1) = (w+a)^(w+1/2) * e^-(w+a) * (c0 + sum of c(k)/(w+k) for k = 1 to a-1)
+    c0 = sqrt(2pi), c(k) = (-1)^(k-1) * (a-k)^(k-1/2) * e^(a-k) / (k-1)!
+*/
+Arb spougeGamma(Arb w, int accu) {
+    //The relative error is below (2pi)^-a
+    int a = (int)ceil((32.0 * accu + 32) / log2(2 * M_PI)) + 1;
+    //The coefficients alternate in sign, so the largest one sets the number of guard digits
+    double maxLog = 0;
+    for(int k = 1;k < a;k++) {
+        double logC = (k - 0.5) * log(a - k) + (a - k) - lgamma(k);
+        if(logC > maxLog) maxLog = logC;
+    }
+    int workAccu = accu + 2 + (int)(maxLog / log(2) / 32);
+    Arb wWork = arbWithAccu(w, workAccu);
+    Arb pi = arb_pi(workAccu);
+    Arb twoPi = multByInt(pi, 2);
+    Arb sum = arb_sqrt(twoPi);
+    Arb e = arb_e(workAccu);
+    //Going down from k = a-1, e^(a-k) is multiplied by e, and 1/(k-1)! by k-1
+    Arb expPower = copyArb(e);
+    Arb fact = arbProductRange(2, a - 1, workAccu);
+    Arb invFact = arb_recip(fact);
+    for(int k = a - 1;k >= 1;k--) {
+        Arb base = intToArb(a - k, workAccu);
+        Arb power = intToArb(k - 1, workAccu);
+        Arb intPow = arb_pow(base, power);
+        Arb root = arb_sqrt(base);
+        Arb scaled = arb_mult(intPow, root);
+        Arb scaledExp = arb_mult(scaled, expPower);
+        Arb coef = arb_mult(scaledExp, invFact);
+        if(k % 2 == 0) coef.sign = 1;
+        Arb shift = intToArb(k, workAccu);
+        Arb denom = arb_add(wWork, shift);
+        Arb term = arb_divide(coef, denom);
+        Arb newSum = arb_add(sum, term);
+        freeArb(sum);
+        sum = newSum;
+        Arb newPower = arb_mult(expPower, e);
+        freeArb(expPower);
+        expPower = newPower;
+        if(k > 1) {
+            Arb newInvFact = multByInt(invFact, k - 1);
+            freeArb(invFact);
+            invFact = newInvFact;
+        }
+        freeArb(base);
+        freeArb(power);
+        freeArb(intPow);
+        freeArb(root);
+        freeArb(scaled);
+        freeArb(scaledExp);
+        freeArb(coef);
+        freeArb(shift);
+        freeArb(denom);
+        freeArb(term);
+    }
+    //(w+a)^(w+1/2) * e^-(w+a) = exp((w+1/2)*ln(w+a) - (w+a)), with extra digits for the integer part of the exponent
+    double wDouble = arbToDouble(w);
+    double magnitude = fabs(wDouble + 0.5) * log(fabs(wDouble) + a) + fabs(wDouble) + a;
+    int expAccu = workAccu + (int)(log2(magnitude) / 32) + 1;
+    Arb wExp = arbWithAccu(w, expAccu);
+    Arb aArb = intToArb(a, expAccu);
+    Arb half = arbPow2(-1, expAccu);
+    Arb base = arb_add(wExp, aArb);
+    Arb lnBase = arb_ln(base);
+    Arb halfW = arb_add(wExp, half);
+    Arb product = arb_mult(lnBase, halfW);
+    Arb exponent = arb_subtract(product, base);
+    Arb prefix = arb_exp(exponent);
+    Arb out = arb_mult(prefix, sum);
+    freeArb(wWork);
+    freeArb(pi);
+    freeArb(twoPi);
+    freeArb(sum);
+    freeArb(e);
+    freeArb(expPower);
+    freeArb(fact);
+    freeArb(invFact);
+    freeArb(wExp);
+    freeArb(aArb);
+    freeArb(half);
+    freeArb(base);
+    freeArb(lnBase);
+    freeArb(halfW);
+    freeArb(product);
+    freeArb(exponent);
+    freeArb(prefix);
+    out.accu = accu;
+    trimZeroes(&out);
+    return out;
+}
+Arb arb_intFact(Arb one) {
+    int accu = one.accu;
+    if(one.sign == 1) {
+        error("cannot call factorial of a negative integer");
+        return intToArb(0, accu);
+    }
+    double n = arbToDouble(one);
+    if(n > factorialTreeLimit) return spougeGamma(one, accu);
+    Arb out = arbProductRange(2, (uint64_t)n + 1, accu + 2);
+    out.accu = accu;
+    trimZeroes(&out);
+    return out;
+}
+Arb arb_gamma(Arb one) {
+    int accu = one.accu;
+    Arb oneArb = intToArb(1, accu + 2);
+    Arb out;
+    //Integers use the factorial product tree
+    if(one.exp >= one.len - 1) {
+        if(one.sign == 1 || arbIsZero(one)) {
+            freeArb(oneArb);
+            error("cannot call factorial of a negative integer");
+            return intToArb(0, accu);
+        }
+        Arb prev = arb_subtract(one, oneArb);
+        prev.accu = accu;
+        out = arb_intFact(prev);
+        freeArb(prev);
+    }
+    //Reflection formula, gamma(x) = pi / (sin(pi*x) * gamma(1-x))
+    else if(one.sign == 1 || (one.exp < 0 && one.mantissa[0] < 0x80000000)) {
+        //sin(pi*x) needs the integer part of x in addition to accu digits
+        int workAccu = accu + 2 + (one.exp > 0 ? one.exp : 0);
+        Arb pi = arb_pi(workAccu);
+        Arb x = arbWithAccu(one, workAccu);
+        Arb angle = arb_mult(pi, x);
+        Arb sine = arb_sin(angle);
+        //gamma(1-x) is gamma(w+1) with w = -x
+        Arb w = copyArb(x);
+        w.sign ^= 1;
+        Arb gammaNeg = spougeGamma(w, accu + 2);
+        Arb denom = arb_mult(sine, gammaNeg);
+        out = arb_divide(pi, denom);
+        freeArb(pi);
+        freeArb(x);
+        freeArb(angle);
+        freeArb(sine);
+        freeArb(w);
+        freeArb(gammaNeg);
+        freeArb(denom);
+    }
+    else {
+        Arb w = arb_subtract(one, oneArb);
+        out = spougeGamma(w, accu);
+        freeArb(w);
+    }
+    freeArb(oneArb);
+    out.accu = accu;
+    trimZeroes(&out);
+    return out;
+}
+Arb arb_fact(Arb one) {
+    if(one.exp >= one.len - 1) return arb_intFact(one);
+    Arb oneArb = intToArb(1, one.accu);
+    Arb next = arb_add(one, oneArb);
+    Arb out = arb_gamma(next);
+    freeArb(oneArb);
+    freeArb(next);
+    return out;
+}
+/*
+    Chudnovsky binary splitting over the terms a to b-1
+    P = (6a-5)(2a-1)(6a-1) * ..., Q = a^3*640320^3/24 * ..., T = sum of (-1)^k*P*(13591409+545140134k) scaled by Q
+*/
+void piSplit(int a, int b, int accu, bool needP, Arb* P, Arb* Q, Arb* T) {
+    if(b - a == 1) {
+        if(a == 0) {
+            *P = intToArb(1, accu);
+            *Q = intToArb(1, accu);
+        }
+        else {
+            *P = intToArb((6LL * a - 5) * (2LL * a - 1) * (6LL * a - 1), accu);
+            Arb cube = intToArb((long long)a * a * a, accu);
+            Arb constant = intToArb(10939058860032000LL, accu);
+            *Q = arb_mult(cube, constant);
+            freeArb(cube);
+            freeArb(constant);
+        }
+        Arb linear = intToArb(13591409 + 545140134LL * a, accu);
+        *T = arb_mult(*P, linear);
+        freeArb(linear);
+        if(a % 2 == 1) T->sign ^= 1;
+        //P is only returned when the caller multiplies it in
+        if(!needP) freeArb(*P);
+        return;
+    }
+    int m = (a + b) / 2;
+    Arb P1, Q1, T1, P2, Q2, T2;
+    piSplit(a, m, accu, true, &P1, &Q1, &T1);
+    piSplit(m, b, accu, needP, &P2, &Q2, &T2);
+    //T = T1*Q2 + P1*T2
+    Arb left = arb_mult(T1, Q2);
+    Arb right = arb_mult(P1, T2);
+    *T = arb_add(left, right);
+    *Q = arb_mult(Q1, Q2);
+    if(needP) {
+        *P = arb_mult(P1, P2);
+        freeArb(P2);
+    }
+    freeArb(left);
+    freeArb(right);
+    freeArb(P1);
+    freeArb(Q1);
+    freeArb(T1);
+    freeArb(Q2);
+    freeArb(T2);
+}
+Arb computePi(int accu) {
+    const uint32_t piStart[] = { 0x243F6A88, 0x85A308D3, 0x13198A2E, 0x03707344, 0xA4093822, 0x299F31D0, 0x082EFA98, 0xEC4E6C89, 0x452821E6, 0x38D01377, 0xBE5466CF, 0x34E90C6C, 0xC0AC29B7, 0xC97C50DD, 0x3F84D5B5, 0xB5470917 };
+    //Low accuracies are read from the table, with the last digit used for rounding
+    if(accu < 17) {
+        Arb out = arbCTR(arbAlloc(17), 17, 0, 0, accu);
+        out.mantissa[0] = 3;
+        memcpy(out.mantissa + 1, piStart, sizeof(piStart));
+        trimZeroes(&out);
+        return out;
+    }
+    /*
+        Chudnovsky algorithm, each term adds about 14.18 decimal digits
+        pi = 426880*sqrt(10005)*Q(0,N) / T(0,N)
+    */
+    int workAccu = accu + 2;
+    int terms = workAccu * 32 * log10(2) / 14.18 + 2;
+    Arb P, Q, T;
+    piSplit(0, terms, workAccu, false, &P, &Q, &T);
+    Arb radicand = intToArb(10005, workAccu);
+    Arb root = arb_sqrt(radicand);
+    Arb scaledRoot = multByInt(root, 426880);
+    Arb numerator = arb_mult(scaledRoot, Q);
+    Arb out = arb_divide(numerator, T);
+    freeArb(Q);
+    freeArb(T);
+    freeArb(radicand);
+    freeArb(root);
+    freeArb(scaledRoot);
+    freeArb(numerator);
+    out.accu = accu;
+    trimZeroes(&out);
+    return out;
+}
+//Computes a constant from scratch to accu digits
+Arb computeArbConstant(ArbConstant id, int accu) {
+    if(id == arbconst_pi) return computePi(accu);
+    if(id == arbconst_e) {
+        Arb one = intToArb(1, accu);
+        Arb out = arb_exp(one);
+        freeArb(one);
+        return out;
+    }
+    if(id == arbconst_ln2 || id == arbconst_ln10) {
+        Arb x = intToArb(id == arbconst_ln2 ? 2 : 10, accu + 1);
+        Arb out = lnNewton(x, accu + 1);
+        freeArb(x);
+        out.accu = accu;
+        trimZeroes(&out);
+        return out;
+    }
+    //phi = (1+sqrt(5))/2
+    Arb five = intToArb(5, accu + 1);
+    Arb half = arbPow2(-1, accu + 1);
+    Arb root = arb_sqrt(five);
+    Arb halfRoot = arb_mult(root, half);
+    Arb out = arb_add(halfRoot, half);
+    freeArb(five);
+    freeArb(root);
+    freeArb(halfRoot);
+    freeArb(half);
+    out.accu = accu;
+    trimZeroes(&out);
+    return out;
+}
+Arb getArbConstant(ArbConstant id, int accu) {
+    Arb* cached = arbConstants + id;
+    if(cached->mantissa == NULL || cached->accu < accu) {
+        //Recompute at the new accuracy, lower accuracies are rounded from it
+        arbConstantComputes++;
+        freeArb(*cached);
+        *cached = computeArbConstant(id, accu);
+        return copyArb(*cached);
+    }
+    arbConstantHits++;
+    if(cached->accu == accu) return copyArb(*cached);
+    return arbWithAccu(*cached, accu);
+}
+void freeArbCaches() {
+    for(int i = 0;i < arbconst_count;i++) {
+        freeArb(arbConstants[i]);
+        arbConstants[i].mantissa = NULL;
+    }
+    for(int i = 0;i < radixPowerCount;i++) freeArb(radixPowers[i]);
+    radixPowerCount = 0;
+    //The workers free their own arenas when they stop
+    arbPoolStop();
+    arbArenaFree();
+}
+Arb arb_pi(int accu) {
+    return getArbConstant(arbconst_pi, accu);
+}
+Arb arb_e(int accu) {
+    return getArbConstant(arbconst_e, accu);
+}
+#pragma endregion
+#pragma enderegion
+#pragma region Decimal Limbs
+/*
+    Decimal Arbs have digits in base 10^9 instead of 2^32, so base 10 is read and printed in linear time.
+    Only the functions below understand them, everything else converts them to binary with decToArb.
+*/
+int decKaratsubaThreshold = 32;
+int decNTTThreshold = 2500;
+int getDecAccuracy() {
+    //As many decimal digits as globalAccuracy binary digits
+    return globalAccuracy * 32 * log10(2) / 9 + 1;
+}
+void trimDec(Arb* dec) {
+    trimLimbs(dec, ARB_DEC_BASE / 2, ARB_DEC_BASE - 1);
+}
+//Returns a copy of one rounded to accu digits
+Arb decWithAccu(Arb one, int accu) {
+    Arb out = arbCTR(arbAlloc(one.len + 1), one.len, one.exp, one.sign, accu);
+    memcpy(out.mantissa, one.mantissa, one.len * sizeof(uint32_t));
+    trimDec(&out);
+    return out;
+}
+Arb parseDec(char* string, int accu) {
+    int strLen = strlen(string);
+    unsigned char digits[strLen + 1];
+    //Exponent of the first significant digit
+    int power = -1;
+    int maxDigits = (accu + 1) * 9;
+    bool hasDecimal = false;
+    int digitIndex = 0;
+    int stringIndex = 0;
+    for(;stringIndex < strLen;stringIndex++) {
+        char ch = string[stringIndex];
+        if(ch == '.') {
+            hasDecimal = true;
+            continue;
+        }
+        if(ch == 'e') break;
+        if(!hasDecimal) power++;
+        if(ch == '0' && digitIndex == 0) {
+            power--;
+            continue;
+        }
+        if(digitIndex == maxDigits) continue;
+        digits[digitIndex++] = ch - '0';
+    }
+    if(digitIndex == 0) return intToArb(0, accu);
+    if(stringIndex < strLen) {
+        bool negative = string[stringIndex + 1] == '-';
+        long long exponent = 0;
+        for(int i = stringIndex + 1 + negative;i < strLen && exponent <= ARB_MAX_EXP * 9LL;i++) exponent = exponent * 10 + string[i] - '0';
+        if(exponent > ARB_MAX_EXP * 9LL) {
+            if(negative) return intToArb(0, accu);
+            error("Overflow in arbitrary-precision number");
+            return intToArb(0, accu);
+        }
+        power += negative ? -exponent : exponent;
+    }
+    //The first digit is in the limb for 10^(9*exp), so the digits are padded to line up with the limbs
+    int exp = power >= 0 ? power / 9 : -((8 - power) / 9);
+    if(exp < -ARB_MAX_EXP) return intToArb(0, accu);
+    if(exp > ARB_MAX_EXP) {
+        error("Overflow in arbitrary-precision number");
+        return intToArb(0, accu);
+    }
+    int pad = 8 - (power - exp * 9);
+    int len = (pad + digitIndex + 8) / 9;
+    Arb out = arbCTR(arbAlloc(len + 1), len, exp, 0, accu);
+    for(int i = pad;i < len * 9;i++) {
+        uint32_t* limb = out.mantissa + i / 9;
+        *limb = *limb * 10 + (i - pad < digitIndex ? digits[i - pad] : 0);
+    }
+    trimDec(&out);
+    return out;
+}
+char* decToString(Arb dec, int digitCount) {
+    if(arbIsZero(dec)) {
+        char* out = calloc(2, 1);
+        out[0] = '0';
+        return out;
+    }
+    if(dec.sign == 1) {
+        dec.sign = 0;
+        char* abs = decToString(dec, digitCount);
+        char* out = calloc(strlen(abs) + 2, 1);
+        out[0] = '-';
+        strcpy(out + 1, abs);
+        free(abs);
+        return out;
     }
-    if(maxLen != out.len) {
-        //https://www.davidhbailey.com/dhbpapers/bbp-alg.pdf
+    //Unpack one digit more than is printed, after a zero that the rounding can carry into
+    char first[10];
+    int lead = snprintf(first, 10, "%u", dec.mantissa[0]);
+    int exponent = dec.exp * 9 + lead - 1;
+    long long available = lead + (dec.len - 1) * 9LL;
+    int count = available > digitCount + 1 ? digitCount + 1 : available;
+    unsigned char* digits = malloc(digitCount + 3);
+    memset(digits, '0', digitCount + 2);
+    int pos = 1;
+    for(int i = 0;i < lead && pos <= count;i++) digits[pos++] = first[i];
+    for(int i = 1;pos <= count;i++) {
+        uint32_t limb = dec.mantissa[i];
+        unsigned char limbDigits[9];
+        for(int j = 8;j >= 0;j--) {
+            limbDigits[j] = '0' + limb % 10;
+            limb /= 10;
+        }
+        for(int j = 0;j < 9 && pos <= count;j++) digits[pos++] = limbDigits[j];
+    }
+    //Round half up
+    if(digits[digitCount + 1] >= '5') {
+        int i = digitCount;
+        while(digits[i] == '9') digits[i--] = '0';
+        digits[i]++;
+    }
+    if(digits[0] != '0') exponent++;
+    else memmove(digits, digits + 1, digitCount);
+    return formatDigits(digits, digitCount, exponent);
+}
+//Returns significant digit pos of a decimal Arb, starting from 0, or '0' past its last limb
+unsigned char decDigitAt(Arb dec, int lead, long long pos) {
+    uint32_t limb = dec.mantissa[0];
+    int place = lead - 1 - pos;
+    if(pos >= lead) {
+        long long index = 1 + (pos - lead) / 9;
+        if(index >= dec.len) return '0';
+        limb = dec.mantissa[index];
+        place = 8 - (pos - lead) % 9;
+    }
+    while(place-- > 0) limb /= 10;
+    return '0' + limb % 10;
+}
+//decToString written to file in blocks, the rounding carry is found first so no digits are held in memory
+long long decWriteDigits(Arb dec, int digitCount, FILE* file) {
+    if(arbIsZero(dec)) {
+        fputc('0', file);
+        return 1;
+    }
+    if(dec.sign == 1) fputc('-', file);
+    char first[10];
+    int lead = snprintf(first, 10, "%u", dec.mantissa[0]);
+    int exponent = dec.exp * 9 + lead - 1;
+    //Round half up, the digit at carryPos is incremented and the nines after it become zeros
+    long long carryPos = digitCount;
+    if(decDigitAt(dec, lead, digitCount) >= '5') {
+        carryPos = digitCount - 1;
+        while(carryPos >= 0 && decDigitAt(dec, lead, carryPos) == '9') carryPos--;
+        if(carryPos < 0) exponent++;
+    }
+    DigitStream stream;
+    stream.file = file;
+    stream.written = 0;
+    stream.pendingZeroes = 0;
+    bool useExponent = exponent < -15 || exponent >= digitCount;
+    if(useExponent) stream.pointAfter = 1;
+    else if(exponent < 0) {
+        fputs("0.", file);
+        for(int i = 0;i < -exponent - 1;i++) fputc('0', file);
+        stream.pointAfter = 0;
+    }
+    else stream.pointAfter = exponent + 1;
+    //A carry out of the first digit leaves a one followed by zeros
+    if(carryPos < 0) streamDigits(&stream, (const unsigned char*)"1", 1);
+    unsigned char digits[1024];
+    long long total = carryPos < 0 ? digitCount - 1 : digitCount;
+    long long pos = 0;
+    while(pos < total) {
+        int count = total - pos < (long long)sizeof(digits) ? total - pos : sizeof(digits);
+        for(int i = 0;i < count;i++, pos++) {
+            if(pos < carryPos) digits[i] = decDigitAt(dec, lead, pos);
+            else if(pos == carryPos) digits[i] = decDigitAt(dec, lead, pos) + 1;
+            else digits[i] = '0';
+        }
+        streamDigits(&stream, digits, count);
+    }
+    finishDigits(&stream);
+    if(useExponent) fprintf(file, "e%d", exponent);
+    return stream.written;
+}
+Arb decToArb(Arb dec, int accu) {
+    if(arbIsZero(dec)) return intToArb(0, accu);
+    //The limbs are blocks of nine decimal digits, the point is then moved to exp
+    Arb integer = arbFromBlocks(dec.mantissa, dec.len, 10);
+    Arb out = arbScaleByPower(integer, 10, 9 * (dec.exp - dec.len + 1), accu);
+    if(!arbIsZero(out)) out.sign = dec.sign;
+    return out;
+}
+double decToDouble(Arb dec) {
+    double out = 0;
+    for(int i = 0;i < dec.len && i < 3;i++) out += dec.mantissa[i] * pow(ARB_DEC_BASE, dec.exp - i);
+    return dec.sign ? -out : out;
+}
+Arb dec_add(Arb one, Arb two) {
+    int accu = one.accu > two.accu ? one.accu : two.accu;
+    if(arbIsZero(two)) return decWithAccu(one, accu);
+    if(arbIsZero(one)) return decWithAccu(two, accu);
+    if(one.sign != two.sign) {
+        //one+two = one-(-two)
+        two.sign = one.sign;
+        return dec_subtract(one, two);
+    }
+    Arb out = arbCTR(arbAlloc(arbSumLen(one, two, accu) + 2), arbSumLen(one, two, accu), one.exp > two.exp ? one.exp : two.exp, one.sign, accu);
+    int oneDiff = out.exp - one.exp, twoDiff = out.exp - two.exp;
+    int oneLen = one.len + oneDiff, twoLen = two.len + twoDiff;
+    uint32_t* outMant = out.mantissa;
+    uint32_t carry = 0;
+    for(int i = out.len - 1;i >= 0;i--) {
+        uint32_t new = carry;
+        if(i >= oneDiff && i < oneLen) new += one.mantissa[i - oneDiff];
+        if(i >= twoDiff && i < twoLen) new += two.mantissa[i - twoDiff];
+        carry = new >= ARB_DEC_BASE;
+        outMant[i] = carry ? new - ARB_DEC_BASE : new;
+    }
+    if(carry != 0) {
+        if(out.len == out.accu + 1) out.len--;
+        memmove(outMant + 1, outMant, out.len * sizeof(uint32_t));
+        out.len++;
+        out.exp++;
+        outMant[0] = carry;
+    }
+    outMant[out.len] = 0;
+    trimDec(&out);
+    return out;
+}
+Arb dec_subtract(Arb one, Arb two) {
+    int accu = one.accu > two.accu ? one.accu : two.accu;
+    if(arbIsZero(two)) return decWithAccu(one, accu);
+    if(arbIsZero(one)) {
+        Arb out = decWithAccu(two, accu);
+        if(!arbIsZero(out)) out.sign ^= 1;
+        return out;
+    }
+    if(one.sign != two.sign) {
+        //one-two = one+(-two)
+        two.sign = one.sign;
+        return dec_add(one, two);
+    }
+    if(arbCmp(one, two) == -1) {
+        Arb out = dec_subtract(two, one);
+        if(!arbIsZero(out)) out.sign ^= 1;
+        return out;
+    }
+    Arb out = arbCTR(arbAlloc(arbSumLen(one, two, accu) + 2), arbSumLen(one, two, accu), one.exp, one.sign, accu);
+    int twoDiff = one.exp - two.exp;
+    uint32_t* outMant = out.mantissa;
+    uint32_t borrow = 0;
+    for(int i = out.len - 1;i >= 0;i--) {
+        uint32_t oneCell = 0, sub = borrow;
+        if(i < one.len) oneCell = one.mantissa[i];
+        if(i >= twoDiff && i < two.len + twoDiff) sub += two.mantissa[i - twoDiff];
+        borrow = oneCell < sub;
+        outMant[i] = borrow ? oneCell + ARB_DEC_BASE - sub : oneCell - sub;
+    }
+    if(borrow != 0) error("Fatal error in subtraction");
+    outMant[out.len] = 0;
+    trimDec(&out);
+    return out;
+}
+/*
+    The decimal kernels follow the binary ones, with carries at 10^9.
+    The 64 bit partial products stay below 10^18, so the schoolbook rows only carry once per digit.
+*/
+void decRunProduct(void* arg) {
+    DigitProduct* product = arg;
+    decMult(product->a, product->aLen, product->b, product->bLen, product->out);
+}
+//digitAddInto in base 10^9
+void decAddInto(uint32_t* dst, int dstLen, const uint32_t* src, int srcLen) {
+    uint32_t carry = 0;
+    int i = dstLen - 1, j = srcLen - 1;
+    for(;j >= 0 && i >= 0;i--, j--) {
+        uint32_t new = dst[i] + src[j] + carry;
+        carry = new >= ARB_DEC_BASE;
+        dst[i] = carry ? new - ARB_DEC_BASE : new;
+    }
+    for(;carry != 0 && i >= 0;i--) {
+        carry = dst[i] == ARB_DEC_BASE - 1;
+        dst[i] = carry ? 0 : dst[i] + 1;
+    }
+}
+//digitSubFrom in base 10^9
+void decSubFrom(uint32_t* dst, int dstLen, const uint32_t* src, int srcLen) {
+    uint32_t borrow = 0;
+    int i = dstLen - 1, j = srcLen - 1;
+    for(;j >= 0 && i >= 0;i--, j--) {
+        uint32_t sub = src[j] + borrow;
+        borrow = dst[i] < sub;
+        dst[i] = borrow ? dst[i] + ARB_DEC_BASE - sub : dst[i] - sub;
+    }
+    for(;borrow != 0 && i >= 0;i--) {
+        borrow = dst[i] == 0;
+        dst[i] = borrow ? ARB_DEC_BASE - 1 : dst[i] - 1;
+    }
+}
+void decMultSchool(const uint32_t* a, int aLen, const uint32_t* b, int bLen, uint32_t* out) {
+    memset(out, 0, (aLen + bLen) * sizeof(uint32_t));
+    for(int i = aLen - 1;i >= 0;i--) {
+        uint64_t aVal = a[i], carry = 0;
+        uint32_t* m = out + i + 1;
+        for(int j = bLen - 1;j >= 0;j--) {
+            uint64_t new = aVal * b[j] + m[j] + carry;
+            m[j] = new % ARB_DEC_BASE;
+            carry = new / ARB_DEC_BASE;
+        }
+        out[i] = carry;
+    }
+}
+//Requires (aLen+1)/2 < bLen <= aLen
+void decMultKaratsuba(const uint32_t* a, int aLen, const uint32_t* b, int bLen, uint32_t* out) {
+    //a = a1*10^(9h) + a0, b = b1*10^(9h) + b0
+    int h = (aLen + 1) / 2;
+    int a1Len = aLen - h, b1Len = bLen - h;
+    const uint32_t* a0 = a + a1Len, * b0 = b + b1Len;
+    int outLen = aLen + bLen;
+    long long mark = arbArenaMark();
+    uint32_t* scratch = arbScratch(4 * h + 4);
+    uint32_t* aSum = scratch, * bSum = scratch + h + 1, * z1 = scratch + 2 * h + 2;
+    memcpy(aSum + 1, a0, h * sizeof(uint32_t));
+    decAddInto(aSum, h + 1, a, a1Len);
+    memcpy(bSum + 1, b0, h * sizeof(uint32_t));
+    decAddInto(bSum, h + 1, b, b1Len);
+    memset(out, 0, outLen * sizeof(uint32_t));
+    DigitProduct products[3] = {
+        { a0,h,b0,h,out + outLen - 2 * h,false },
+        { a,a1Len,b,b1Len,out,false },
+        { aSum,h + 1,bSum,h + 1,z1,false },
+    };
+    arbRunAll(&decRunProduct, products, sizeof(DigitProduct), 3, arbUseThreads(bLen));
+    decSubFrom(z1, 2 * h + 2, out + outLen - 2 * h, 2 * h);
+    decSubFrom(z1, 2 * h + 2, out, a1Len + b1Len);
+    decAddInto(out, outLen - h, z1, 2 * h + 2);
+    arbArenaRelease(mark);
+}
+void decMult(const uint32_t* a, int aLen, const uint32_t* b, int bLen, uint32_t* out) {
+    if(aLen < bLen) {
+        const uint32_t* tmp = a;
+        a = b;
+        b = tmp;
+        int tmpLen = aLen;
+        aLen = bLen;
+        bLen = tmpLen;
+    }
+    if(bLen == 0) {
+        memset(out, 0, aLen * sizeof(uint32_t));
+        return;
+    }
+    if(bLen < decKaratsubaThreshold) {
+        decMultSchool(a, aLen, b, bLen, out);
+        return;
+    }
+    if(bLen >= decNTTThreshold && aLen + bLen <= nttMaxDigits) {
+        nttMultiply(a, aLen, b, bLen, out, true);
+        return;
+    }
+    if(bLen <= (aLen + 1) / 2) {
+        int outLen = aLen + bLen;
+        long long mark = arbArenaMark();
+        uint32_t* chunk = arbScratch(bLen * 2);
+        memset(out, 0, outLen * sizeof(uint32_t));
+        int pos = aLen;
+        while(pos > 0) {
+            int len = pos < bLen ? pos : bLen;
+            decMult(a + pos - len, len, b, bLen, chunk);
+            decAddInto(out, outLen - (aLen - pos), chunk, len + bLen);
+            pos -= len;
+        }
+        arbArenaRelease(mark);
+        return;
+    }
+    decMultKaratsuba(a, aLen, b, bLen, out);
+}
+Arb dec_mult(Arb one, Arb two) {
+    int accu = one.accu > two.accu ? one.accu : two.accu;
+    //Leave room for trimDec to read the rounding digit
+    Arb out = arbCTR(arbAlloc(one.len + two.len + 1), one.len + two.len, one.exp + two.exp + 1, one.sign ^ two.sign, accu);
+    decMult(one.mantissa, one.len, two.mantissa, two.len, out.mantissa);
+    trimDec(&out);
+    return out;
+}
+#pragma endregion
+#pragma region Ball Arithmetic
+//Added to every radius computed with doubles, to cover their rounding
+#define BALL_PAD 1e-9
+//Upper bound of log2(|one|), -INFINITY for zero
+double arbLog2Up(Arb one) {
+    if(arbIsZero(one)) return -INFINITY;
+    return 32.0 * one.exp + log2(one.mantissa[0] + 1.0) + BALL_PAD;
+}
+//Lower bound of log2(|one|), -INFINITY for zero
+double arbLog2Down(Arb one) {
+    if(arbIsZero(one)) return -INFINITY;
+    return 32.0 * one.exp + log2((double)one.mantissa[0]) - BALL_PAD;
+}
+//Returns log2(2^a + 2^b), rounded up
+double radSum(double a, double b) {
+    if(a == -INFINITY) return b;
+    if(b == -INFINITY) return a;
+    double hi = a > b ? a : b;
+    double lo = a > b ? b : a;
+    return hi + log2(1 + exp2(lo - hi)) + BALL_PAD;
+}
+//Returns log2(2^a * 2^b), where a zero radius stays zero even if the other is infinite
+double radMult(double a, double b) {
+    if(a == -INFINITY || b == -INFINITY) return -INFINITY;
+    return a + b;
+}
+//Lower bound of log2(|one.mid| - radius), one must not contain zero
+double ballGap(Ball one) {
+    double low = arbLog2Down(one.mid);
+    return low + log2(1 - exp2(one.rad - low)) - BALL_PAD;
+}
+//Whether every value in one has the same sign as the midpoint, and is nonzero
+bool ballExcludesZero(Ball one) {
+    return !arbIsZero(one.mid) && one.rad < arbLog2Down(one.mid);
+}
+//log2 of ulps units in the last digit of mid, which bounds the rounding of a kernel
+double ballRoundErr(Arb mid, int ulps) {
+    if(ulps == 0 || arbIsZero(mid)) return -INFINITY;
+    return 32.0 * (mid.exp - mid.accu + 1) + log2(ulps);
+}
+Ball arbToBall(Arb mid, int ulps) {
+    Ball out;
+    out.mid = mid;
+    out.rad = ballRoundErr(mid, ulps);
+    return out;
+}
+Ball copyBall(Ball one) {
+    one.mid = copyArb(one.mid);
+    return one;
+}
+Ball parseBall(char* string, int base, int accu) {
+    //A literal is exact if two more digits do not change it
+    Arb wide = parseArb(string, base, accu + 2);
+    Arb mid = parseArb(string, base, accu);
+    bool exact = arbCmp(wide, mid) == 0;
+    freeArb(wide);
+    return arbToBall(mid, exact ? 0 : 1);
+}
+int ballDigits(Ball one, int base) {
+    if(one.rad == -INFINITY) return INT32_MAX;
+    double bits = arbLog2Down(one.mid) - one.rad - 1;
+    return bits > 0 ? (int)(bits / log2(base)) : 0;
+}
+char* ballToString(Ball one, int base, int digitCount) {
+    if(one.rad != -INFINITY) {
+        //Digits within the radius are not printed, so the error is below one unit in the last digit
+        int guaranteed = ballDigits(one, base);
+        if(guaranteed == 0) {
+            //No digit is known, print the midpoint with two digits and the radius rounded up
+            if(one.rad == INFINITY) return strcpy(calloc(10, 1), "0 +/- inf");
+            double exp10 = one.rad * log10(2);
+            int exponent = floor(exp10);
+            double lead = ceil(pow(10, exp10 - exponent) * 10) / 10;
+            char* mid = arbToString(one.mid, base, 2);
+            char* out = calloc(strlen(mid) + 40, 1);
+            snprintf(out, strlen(mid) + 40, "%s +/- %ge%d", mid, lead, exponent);
+            free(mid);
+            return out;
+        }
+        if(guaranteed < digitCount) digitCount = guaranteed;
+    }
+    return arbToString(one.mid, base, digitCount);
+}
+Ball ball_add(Ball one, Ball two) {
+    Ball out;
+    out.mid = arb_add(one.mid, two.mid);
+    //The sum is exact when every digit of both operands fits in the accuracy
+    int lowOne = one.mid.exp - one.mid.len + 1;
+    int lowTwo = two.mid.exp - two.mid.len + 1;
+    int low = lowOne < lowTwo ? lowOne : lowTwo;
+    int high = (one.mid.exp > two.mid.exp ? one.mid.exp : two.mid.exp) + 1;
+    bool exact = high - low + 1 <= out.mid.accu;
+    out.rad = radSum(radSum(one.rad, two.rad), ballRoundErr(out.mid, exact ? 0 : 1));
+    return out;
+}
+Ball ball_subtract(Ball one, Ball two) {
+    if(!arbIsZero(two.mid)) two.mid.sign ^= 1;
+    return ball_add(one, two);
+}
+Ball ball_mult(Ball one, Ball two) {
+    Ball out;
+    out.mid = arb_mult(one.mid, two.mid);
+    bool exact = one.mid.len + two.mid.len <= out.mid.accu;
+    //|xy - ab| <= |a|*r2 + |b|*r1 + r1*r2
+    double rad = radSum(radMult(arbLog2Up(one.mid), two.rad), radMult(arbLog2Up(two.mid), one.rad));
+    rad = radSum(rad, radMult(one.rad, two.rad));
+    out.rad = radSum(rad, ballRoundErr(out.mid, exact ? 0 : 1));
+    return out;
+}
+Ball ball_divide(Ball one, Ball two) {
+    Ball out;
+    if(!ballExcludesZero(two)) {
+        error("Division by a ball that contains zero");
+        out.mid = intToArb(0, one.mid.accu);
+        out.rad = INFINITY;
+        return out;
+    }
+    out.mid = arb_divide(one.mid, two.mid);
+    //|x/y - a/b| <= (|a|*r2 + |b|*r1) / (|b|*(|b|-r2))
+    double rad = radSum(radMult(arbLog2Up(one.mid), two.rad), radMult(arbLog2Up(two.mid), one.rad));
+    if(rad != -INFINITY) rad -= arbLog2Down(two.mid) + ballGap(two);
+    out.rad = radSum(rad, ballRoundErr(out.mid, 2));
+    return out;
+}
+Ball ball_sqrt(Ball one) {
+    Ball out;
+    if(!ballExcludesZero(one) && one.rad != -INFINITY) {
+        //The ball reaches zero, so the result is within sqrt(|mid|+rad) of zero
+        out.mid = intToArb(0, one.mid.accu);
+        out.rad = radSum(arbLog2Up(one.mid), one.rad) / 2 + BALL_PAD;
+        return out;
+    }
+    if(one.mid.sign == 1) {
+        error("Square root of a negative ball");
+        out.mid = intToArb(0, one.mid.accu);
+        out.rad = INFINITY;
+        return out;
+    }
+    out.mid = arb_sqrt(one.mid);
+    //|sqrt(x) - sqrt(a)| <= r / sqrt(a-r)
+    double rad = one.rad == -INFINITY ? -INFINITY : one.rad - ballGap(one) / 2;
+    out.rad = radSum(rad, ballRoundErr(out.mid, 2));
+    return out;
+}
+Ball ball_exp(Ball one) {
+    Ball out;
+    out.mid = arb_exp(one.mid);
+    //|exp(x) - exp(a)| <= exp(a) * (exp(r)-1)
+    double rad = -INFINITY;
+    //Below 2^-30, exp(r)-1 is r rounded up by the pad
+    if(one.rad < -30) rad = radMult(arbLog2Up(out.mid), one.rad + BALL_PAD);
+    else rad = arbLog2Up(out.mid) + log2(expm1(exp2(one.rad))) + BALL_PAD;
+    out.rad = radSum(rad, ballRoundErr(out.mid, 4));
+    return out;
+}
+Ball ball_ln(Ball one) {
+    Ball out;
+    if(!ballExcludesZero(one) || one.mid.sign == 1) {
+        error("Logarithm of a ball that is not positive");
+        out.mid = intToArb(0, one.mid.accu);
+        out.rad = INFINITY;
+        return out;
+    }
+    out.mid = arb_ln(one.mid);
+    //|ln(x) - ln(a)| <= r / (a-r)
+    double rad = one.rad == -INFINITY ? -INFINITY : one.rad - ballGap(one);
+    //ln is computed with an absolute error near one
+    double roundErr = ballRoundErr(out.mid, 4);
+    double absErr = 32.0 * (1 - out.mid.accu) + 2;
+    out.rad = radSum(rad, roundErr > absErr ? roundErr : absErr);
+    return out;
+}
+//Sine or cosine, both have a derivative of at most one
+Ball ballSinCos(Ball one, bool cosine) {
+    Ball out;
+    if(cosine) arbSinCos(one.mid, NULL, &out.mid);
+    else arbSinCos(one.mid, &out.mid, NULL);
+    //Arguments that are reduced by multiples of pi/2 get an absolute error
+    double roundErr = ballRoundErr(out.mid, 4);
+    if(cosine || arbLog2Up(one.mid) > -1) {
+        double absErr = 32.0 * (1 - out.mid.accu) + 2;
+        if(absErr > roundErr) roundErr = absErr;
+    }
+    out.rad = radSum(one.rad, roundErr);
+    return out;
+}
+Ball ball_sin(Ball one) {
+    return ballSinCos(one, false);
+}
+Ball ball_cos(Ball one) {
+    return ballSinCos(one, true);
+}
+Ball ball_tan(Ball one) {
+    Ball sin = ball_sin(one);
+    Ball cos = ball_cos(one);
+    Ball out = ball_divide(sin, cos);
+    freeArb(sin.mid);
+    freeArb(cos.mid);
+    return out;
+}
+Ball ball_atan(Ball one) {
+    Ball out;
+    out.mid = arb_atan(one.mid);
+    //The derivative of atan is at most one
+    out.rad = radSum(one.rad, ballRoundErr(out.mid, 4));
+    return out;
+}
+Ball ball_pow(Ball one, Ball two) {
+    //Exact integer powers use repeated squaring
+    Arb power = two.mid;
+    if(two.rad == -INFINITY && power.exp == 0 && power.len == 1) {
+        uint32_t n = power.mantissa[0];
+        Ball square = copyBall(one);
+        Ball out = arbToBall(intToArb(1, one.mid.accu), 0);
+        while(n != 0) {
+            if(n & 1) {
+                Ball product = ball_mult(out, square);
+                freeArb(out.mid);
+                out = product;
+            }
+            n >>= 1;
+            if(n != 0) {
+                Ball newSquare = ball_mult(square, square);
+                freeArb(square.mid);
+                square = newSquare;
+            }
+        }
+        freeArb(square.mid);
+        if(power.sign == 1) {
+            Ball unit = arbToBall(intToArb(1, one.mid.accu), 0);
+            Ball recip = ball_divide(unit, out);
+            freeArb(unit.mid);
+            freeArb(out.mid);
+            out = recip;
+        }
+        return out;
+    }
+    //one^0.5
+    if(two.rad == -INFINITY && power.sign == 0 && power.exp == -1 && power.len == 1 && power.mantissa[0] == 0x80000000) return ball_sqrt(one);
+    //exp(two*ln(one))
+    Ball ln = ball_ln(one);
+    if(globalError) return ln;
+    Ball product = ball_mult(ln, two);
+    Ball out = ball_exp(product);
+    freeArb(ln.mid);
+    freeArb(product.mid);
+    return out;
+}
+#pragma endregion
+#pragma region Number Theory
+/*
+    The number theory kernels work on nonnegative integers stored as len big-endian digits,
+    the same layout as the multiplication kernels. Shorter numbers are padded with leading zeroes.
+    Temporary digits come from the arena, so callers mark and release it around them.
+*/
+int pollardStepLimit = 1 << 20;
+//Primes used for trial division and as the Miller-Rabin bases
+const uint32_t smallPrimes[16] = { 2,3,5,7,11,13,17,19,23,29,31,37,41,43,47,53 };
+//Writes the integer part of |one| into len digits, len must be at least one.exp+1
+void arbToDigits(Arb one, uint32_t* out, int len) {
+    memset(out, 0, len * sizeof(uint32_t));
+    if(arbIsZero(one)) return;
+    for(int i = 0;i < one.len && i <= one.exp;i++) out[len - 1 - one.exp + i] = one.mantissa[i];
+}
+//Returns the integer in digits, with an accuracy of at least accu
+Arb digitsToArb(const uint32_t* digits, int len, int accu) {
+    int start = 0;
+    while(start < len - 1 && digits[start] == 0) start++;
+    int outLen = len - start;
+    Arb out = arbCTR(arbAlloc(outLen + 1), outLen, outLen - 1, 0, accu > outLen ? accu : outLen);
+    memcpy(out.mantissa, digits + start, outLen * sizeof(uint32_t));
+    trimZeroes(&out);
+    return out;
+}
+int digitCmp(const uint32_t* a, const uint32_t* b, int len) {
+    for(int i = 0;i < len;i++) if(a[i] != b[i]) return a[i] > b[i] ? 1 : -1;
+    return 0;
+}
+bool digitIsZero(const uint32_t* a, int len) {
+    for(int i = 0;i < len;i++) if(a[i] != 0) return false;
+    return true;
+}
+//a -= b, returns the borrow out of the leading digit
+uint32_t digitSubtractInto(uint32_t* a, const uint32_t* b, int len) {
+    uint64_t borrow = 0;
+    for(int i = len - 1;i >= 0;i--) {
+        uint64_t sub = b[i] + borrow;
+        borrow = a[i] < sub;
+        a[i] -= sub;
+    }
+    return borrow;
+}
+uint32_t digitModSmall(const uint32_t* a, int len, uint32_t divisor) {
+    uint64_t rem = 0;
+    for(int i = 0;i < len;i++) rem = (rem << 32 | a[i]) % divisor;
+    return rem;
+}
+//Divides a by divisor in place and returns the remainder
+uint32_t digitDivSmall(uint32_t* a, int len, uint32_t divisor) {
+    uint64_t rem = 0;
+    for(int i = 0;i < len;i++) {
+        uint64_t cur = rem << 32 | a[i];
+        a[i] = cur / divisor;
+        rem = cur % divisor;
+    }
+    return rem;
+}
+//Number of trailing zero bits, a must not be zero
+int digitTrailingZeroes(const uint32_t* a, int len) {
+    int out = 0, i = len - 1;
+    while(a[i] == 0) {
+        out += 32;
+        i--;
+    }
+    uint32_t digit = a[i];
+    while((digit & 1) == 0) {
+        digit >>= 1;
+        out++;
+    }
+    return out;
+}
+void digitShiftRight(uint32_t* a, int len, int bits) {
+    int digits = bits >> 5;
+    bits &= 31;
+    if(digits >= len) {
+        memset(a, 0, len * sizeof(uint32_t));
+        return;
+    }
+    if(digits != 0) {
+        memmove(a + digits, a, (len - digits) * sizeof(uint32_t));
+        memset(a, 0, digits * sizeof(uint32_t));
+    }
+    if(bits == 0) return;
+    for(int i = len - 1;i > 0;i--) a[i] = a[i] >> bits | a[i - 1] << (32 - bits);
+    a[0] >>= bits;
+}
+//Bits shifted out of the leading digit are lost
+void digitShiftLeft(uint32_t* a, int len, int bits) {
+    int digits = bits >> 5;
+    bits &= 31;
+    if(digits >= len) {
+        memset(a, 0, len * sizeof(uint32_t));
+        return;
+    }
+    if(digits != 0) {
+        memmove(a, a + digits, (len - digits) * sizeof(uint32_t));
+        memset(a + len - digits, 0, digits * sizeof(uint32_t));
+    }
+    if(bits == 0) return;
+    for(int i = 0;i < len - 1;i++) a[i] = a[i] << bits | a[i + 1] >> (32 - bits);
+    a[len - 1] <<= bits;
+}
+//Binary gcd, a and b are overwritten
+void digitGcd(uint32_t* a, uint32_t* b, int len, uint32_t* out) {
+    if(digitIsZero(a, len) || digitIsZero(b, len)) {
+        memcpy(out, digitIsZero(a, len) ? b : a, len * sizeof(uint32_t));
+        return;
+    }
+    int aZeroes = digitTrailingZeroes(a, len), bZeroes = digitTrailingZeroes(b, len);
+    int shift = aZeroes < bZeroes ? aZeroes : bZeroes;
+    digitShiftRight(a, len, aZeroes);
+    digitShiftRight(b, len, bZeroes);
+    //Both are odd, so their difference is even
+    while(true) {
+        if(digitCmp(a, b, len) > 0) {
+            uint32_t* tmp = a;
+            a = b;
+            b = tmp;
+        }
+        digitSubtractInto(b, a, len);
+        if(digitIsZero(b, len)) break;
+        digitShiftRight(b, len, digitTrailingZeroes(b, len));
+    }
+    memcpy(out, a, len * sizeof(uint32_t));
+    digitShiftLeft(out, len, shift);
+}
+//a = a+b mod m, where a and b are less than m
+void digitAddMod(uint32_t* a, const uint32_t* b, const uint32_t* mod, int len) {
+    uint64_t carry = 0;
+    for(int i = len - 1;i >= 0;i--) {
+        uint64_t new = (uint64_t)a[i] + b[i] + carry;
+        a[i] = new;
+        carry = new >> 32;
+    }
+    if(carry != 0 || digitCmp(a, mod, len) >= 0) digitSubtractInto(a, mod, len);
+}
+/**
+ * Montgomery representation modulo an odd number
+ * x is stored as x*R mod m, where R = 2^(32*len)
+ * @param inv -m^-1 mod 2^32
+ * @param one R mod m, which is 1 in Montgomery form
+ * @param r2 R^2 mod m, used for conversions
+ * @param scratch len+2 little-endian digits for montMult
+ */
+typedef struct MontgomeryStruct {
+    const uint32_t* mod;
+    int len;
+    uint32_t inv;
+    uint32_t* one;
+    uint32_t* r2;
+    uint32_t* scratch;
+} Montgomery;
+//mod must be odd and greater than one
+Montgomery montgomeryCTR(const uint32_t* mod, int len) {
+    Montgomery out;
+    out.mod = mod;
+    out.len = len;
+    //Newton's iteration for mod^-1 mod 2^32, each step doubles the number of correct bits
+    uint32_t low = mod[len - 1], x = low;
+    for(int i = 0;i < 5;i++) x *= 2 - low * x;
+    out.inv = -x;
+    out.one = arbScratch(len);
+    out.r2 = arbScratch(len);
+    out.scratch = arbScratch(len + 2);
+    //R mod m and R^2 mod m by repeated doubling
+    out.one[len - 1] = 1;
+    for(int i = 0;i < 32 * len;i++) digitAddMod(out.one, out.one, mod, len);
+    memcpy(out.r2, out.one, len * sizeof(uint32_t));
+    for(int i = 0;i < 32 * len;i++) digitAddMod(out.r2, out.r2, mod, len);
+    return out;
+}
+//out = a*b/R mod m, requires a*b < m*R, out may be a or b
+void montMult(const Montgomery* ctx, const uint32_t* a, const uint32_t* b, uint32_t* out) {
+    int len = ctx->len;
+    const uint32_t* mod = ctx->mod;
+    uint32_t* t = ctx->scratch;
+    memset(t, 0, (len + 2) * sizeof(uint32_t));
+    for(int i = len - 1;i >= 0;i--) {
+        //t += a[i]*b
+        uint64_t aDigit = a[i], carry = 0;
+        for(int j = 0;j < len;j++) {
+            uint64_t new = aDigit * b[len - 1 - j] + t[j] + carry;
+            t[j] = new;
+            carry = new >> 32;
+        }
+        uint64_t top = (uint64_t)t[len] + carry;
+        t[len] = top;
+        t[len + 1] = top >> 32;
+        //t = (t + q*m) / 2^32, where q clears the lowest digit
+        uint64_t q = (uint32_t)(t[0] * ctx->inv);
+        carry = (q * mod[len - 1] + t[0]) >> 32;
+        for(int j = 1;j < len;j++) {
+            uint64_t new = q * mod[len - 1 - j] + t[j] + carry;
+            t[j - 1] = new;
+            carry = new >> 32;
+        }
+        top = (uint64_t)t[len] + carry;
+        t[len - 1] = top;
+        t[len] = t[len + 1] + (top >> 32);
+    }
+    //t < 2m, so one subtraction is enough
+    for(int j = 0;j < len;j++) out[len - 1 - j] = t[j];
+    if(t[len] != 0 || digitCmp(out, mod, len) >= 0) digitSubtractInto(out, mod, len);
+}
+//out = base^power in Montgomery form, out must not be base
+void montPow(const Montgomery* ctx, const uint32_t* base, const uint32_t* power, int powerLen, uint32_t* out) {
+    memcpy(out, ctx->one, ctx->len * sizeof(uint32_t));
+    bool started = false;
+    for(int i = 0;i < powerLen;i++) for(int bit = 31;bit >= 0;bit--) {
+        if(started) montMult(ctx, out, out, out);
+        if(power[i] >> bit & 1) {
+            montMult(ctx, out, base, out);
+            started = true;
+        }
+    }
+}
+//Miller-Rabin test with the bases in smallPrimes, the modulus must be odd and greater than 53
+//It is deterministic below 3.3*10^24, and wrong with a probability below 4^-16 above that
+bool millerRabin(const Montgomery* ctx) {
+    int len = ctx->len;
+    uint32_t* d = arbScratch(len), * x = arbScratch(len), * minusOne = arbScratch(len), * base = arbScratch(len);
+    //n-1 = d*2^s
+    memcpy(d, ctx->mod, len * sizeof(uint32_t));
+    d[len - 1]--;
+    int s = digitTrailingZeroes(d, len);
+    digitShiftRight(d, len, s);
+    //n-1 in Montgomery form is n-(R mod n)
+    memcpy(minusOne, ctx->mod, len * sizeof(uint32_t));
+    digitSubtractInto(minusOne, ctx->one, len);
+    for(int i = 0;i < 16;i++) {
+        memset(base, 0, len * sizeof(uint32_t));
+        base[len - 1] = smallPrimes[i];
+        montMult(ctx, base, ctx->r2, base);
+        montPow(ctx, base, d, len, x);
+        if(digitCmp(x, ctx->one, len) == 0 || digitCmp(x, minusOne, len) == 0) continue;
+        int j;
+        for(j = 1;j < s;j++) {
+            montMult(ctx, x, x, x);
+            if(digitCmp(x, minusOne, len) == 0) break;
+        }
+        if(j >= s) return false;
+    }
+    return true;
+}
+//n must not have leading zeroes
+bool digitIsPrime(const uint32_t* n, int len) {
+    if(len == 1 && n[0] < 2) return false;
+    for(int i = 0;i < 16;i++) {
+        if(len == 1 && n[0] == smallPrimes[i]) return true;
+        if(digitModSmall(n, len, smallPrimes[i]) == 0) return false;
+    }
+    //No factor up to 53, and less than 59^2
+    if(len == 1 && n[0] < 59 * 59) return true;
+    Montgomery ctx = montgomeryCTR(n, len);
+    return millerRabin(&ctx);
+}
+//factor = |x-y|
+void digitAbsDiff(const uint32_t* x, const uint32_t* y, int len, uint32_t* out) {
+    if(digitCmp(x, y, len) < 0) {
+        const uint32_t* tmp = x;
+        x = y;
+        y = tmp;
+    }
+    memcpy(out, x, len * sizeof(uint32_t));
+    digitSubtractInto(out, y, len);
+}
+/*
+    Brent's variant of Pollard's rho on the odd composite ctx->mod, iterating y -> y^2+c
+    Writes a nontrivial factor to factor and returns 1, returns 0 when the step limit is reached,
+    or -1 if every factor was found at once and another c is needed
+*/
+int pollardBrent(const Montgomery* ctx, uint32_t c, uint32_t* factor) {
+    int len = ctx->len;
+    uint32_t* y = arbScratch(len), * x = arbScratch(len), * ys = arbScratch(len), * q = arbScratch(len);
+    uint32_t* cMont = arbScratch(len), * diff = arbScratch(len), * gcdA = arbScratch(len), * gcdB = arbScratch(len);
+    cMont[len - 1] = c;
+    montMult(ctx, cMont, ctx->r2, cMont);
+    memcpy(y, ctx->one, len * sizeof(uint32_t));
+    memcpy(q, ctx->one, len * sizeof(uint32_t));
+    bool found = false;
+    long long steps = 0;
+    //Products of |x-y| are taken in blocks of 128 steps, with one gcd per block
+    for(long long r = 1;!found;r *= 2) {
+        if(steps > pollardStepLimit) return 0;
+        memcpy(x, y, len * sizeof(uint32_t));
+        for(long long i = 0;i < r;i++) {
+            montMult(ctx, y, y, y);
+            digitAddMod(y, cMont, ctx->mod, len);
+        }
+        steps += r;
+        for(long long k = 0;k < r && !found;k += 128) {
+            memcpy(ys, y, len * sizeof(uint32_t));
+            long long block = r - k < 128 ? r - k : 128;
+            for(long long i = 0;i < block;i++) {
+                montMult(ctx, y, y, y);
+                digitAddMod(y, cMont, ctx->mod, len);
+                digitAbsDiff(x, y, len, diff);
+                montMult(ctx, q, diff, q);
+            }
+            steps += block;
+            //The factors of R do not matter, because m is odd
+            memcpy(gcdA, q, len * sizeof(uint32_t));
+            memcpy(gcdB, ctx->mod, len * sizeof(uint32_t));
+            digitGcd(gcdA, gcdB, len, factor);
+            found = !(factor[len - 1] == 1 && digitIsZero(factor, len - 1));
+        }
+    }
+    if(digitCmp(factor, ctx->mod, len) != 0) return 1;
+    //The block collapsed to zero, so redo it one step at a time
+    do {
+        montMult(ctx, ys, ys, ys);
+        digitAddMod(ys, cMont, ctx->mod, len);
+        digitAbsDiff(x, ys, len, diff);
+        memcpy(gcdB, ctx->mod, len * sizeof(uint32_t));
+        digitGcd(diff, gcdB, len, factor);
+    } while(factor[len - 1] == 1 && digitIsZero(factor, len - 1));
+    return digitCmp(factor, ctx->mod, len) == 0 ? -1 : 1;
+}
+bool arbIsPrime(Arb one) {
+    //Only integers can be prime
+    if(arbIsZero(one) || one.exp < one.len - 1) return false;
+    int len = one.exp + 1;
+    long long mark = arbArenaMark();
+    uint32_t* n = arbScratch(len);
+    arbToDigits(one, n, len);
+    bool out = digitIsPrime(n, len);
+    arbArenaRelease(mark);
+    return out;
+}
+Arb arbIntDivMod(Arb one, Arb two, Arb* quotient) {
+    int userAccu = one.accu > two.accu ? one.accu : two.accu;
+    //Every intermediate is an exact integer at this accuracy
+    int accu = (one.exp > two.exp ? one.exp : two.exp) + 4;
+    one.sign = two.sign = 0;
+    one.accu = two.accu = accu;
+    Arb ratio = arb_divide(one, two);
+    Arb q = arb_floor(ratio);
+    Arb product = arb_mult(q, two);
+    Arb rem = arb_subtract(one, product);
+    freeArb(ratio);
+    freeArb(product);
+    //The quotient is at most one away
+    Arb oneArb = intToArb(1, accu);
+    while(rem.sign == 1 || arbCmp(rem, two) >= 0) {
+        bool low = rem.sign == 1;
+        Arb newRem = low ? arb_add(rem, two) : arb_subtract(rem, two);
+        Arb newQ = low ? arb_subtract(q, oneArb) : arb_add(q, oneArb);
+        freeArb(rem);
+        freeArb(q);
+        rem = newRem;
+        q = newQ;
+    }
+    freeArb(oneArb);
+    rem.accu = q.accu = userAccu > accu ? userAccu : accu;
+    if(quotient != NULL) *quotient = q;
+    else freeArb(q);
+    return rem;
+}
+Arb arbIntMod(Arb one, Arb two) {
+    Arb out = arbIntDivMod(one, two, NULL);
+    if(one.sign == 1 && !arbIsZero(out)) {
+        two.sign = 0;
+        Arb flipped = arb_subtract(two, out);
+        flipped.accu = out.accu;
+        freeArb(out);
+        return flipped;
+    }
+    return out;
+}
+Arb arb_gcd(Arb one, Arb two) {
+    int accu = one.accu > two.accu ? one.accu : two.accu;
+    int len = (one.exp > two.exp ? one.exp : two.exp) + 1;
+    if(len < 1) len = 1;
+    long long mark = arbArenaMark();
+    uint32_t* a = arbScratch(len), * b = arbScratch(len), * gcd = arbScratch(len);
+    arbToDigits(one, a, len);
+    arbToDigits(two, b, len);
+    digitGcd(a, b, len, gcd);
+    Arb out = digitsToArb(gcd, len, accu);
+    arbArenaRelease(mark);
+    return out;
+}
+Arb arb_modpow(Arb base, Arb power, Arb mod) {
+    int accu = base.accu > mod.accu ? base.accu : mod.accu;
+    if(arbIsZero(mod)) {
+        error("modpow with a modulus of zero");
+        return intToArb(0, accu);
+    }
+    if(power.sign == 1) {
+        error("modpow does not support negative powers");
+        return intToArb(0, accu);
     }
+    mod.sign = 0;
+    int len = mod.exp + 1, powerLen = power.exp + 1;
+    if(powerLen < 1) powerLen = 1;
+    Arb reduced = arbIntMod(base, mod);
+    long long mark = arbArenaMark();
+    uint32_t* m = arbScratch(len), * b = arbScratch(len), * p = arbScratch(powerLen), * result = arbScratch(len);
+    arbToDigits(mod, m, len);
+    arbToDigits(reduced, b, len);
+    arbToDigits(power, p, powerLen);
+    Arb out;
+    if((m[len - 1] & 1) && !(len == 1 && m[0] == 1)) {
+        Montgomery ctx = montgomeryCTR(m, len);
+        montMult(&ctx, b, ctx.r2, b);
+        montPow(&ctx, b, p, powerLen, result);
+        uint32_t* unit = arbScratch(len);
+        unit[len - 1] = 1;
+        montMult(&ctx, result, unit, result);
+        out = digitsToArb(result, len, accu);
+    }
+    else {
+        //Even moduli are reduced with a division after each step
+        int workAccu = 2 * len + 2;
+        reduced.accu = workAccu;
+        Arb oneArb = intToArb(1, workAccu);
+        out = arbIntMod(oneArb, mod);
+        freeArb(oneArb);
+        for(int i = 0;i < powerLen;i++) for(int bit = 31;bit >= 0;bit--) {
+            out.accu = workAccu;
+            Arb square = arb_mult(out, out);
+            freeArb(out);
+            out = arbIntMod(square, mod);
+            freeArb(square);
+            if(p[i] >> bit & 1) {
+                out.accu = workAccu;
+                Arb product = arb_mult(out, reduced);
+                freeArb(out);
+                out = arbIntMod(product, mod);
+                freeArb(product);
+            }
+        }
+        out.accu = accu > out.len ? accu : out.len;
+    }
+    arbArenaRelease(mark);
+    freeArb(reduced);
     return out;
 }
-#pragma enderegion
\ No newline at end of file
+//Returns a nontrivial factor of the odd composite one, or zero if Pollard's rho did not find one
+Arb arbRhoFactor(Arb one) {
+    int len = one.exp + 1;
+    long long mark = arbArenaMark();
+    uint32_t* n = arbScratch(len), * factor = arbScratch(len);
+    arbToDigits(one, n, len);
+    Montgomery ctx = montgomeryCTR(n, len);
+    int found = -1;
+    for(uint32_t c = 1;c <= 4 && found == -1;c++) found = pollardBrent(&ctx, c, factor);
+    Arb out = found == 1 ? digitsToArb(factor, len, one.accu) : intToArb(0, one.accu);
+    arbArenaRelease(mark);
+    return out;
+}
+int arbCmpValue(const void* one, const void* two) {
+    return arbCmp(*(const Arb*)one, *(const Arb*)two);
+}
+Arb* arb_factor(Arb one, int* count, int* primeCount) {
+    int size = 16, pendingSize = 4, pendingCount = 0;
+    Arb* out = calloc(size, sizeof(Arb));
+    Arb* pending = calloc(pendingSize, sizeof(Arb));
+    if(out == NULL || pending == NULL) {
+        free(out);
+        free(pending);
+        error(mallocError);
+        return NULL;
+    }
+    *count = 0;
+    *primeCount = 0;
+    if(arbIsZero(one)) {
+        free(pending);
+        return out;
+    }
+    int len = one.exp + 1;
+    if(len < 1) len = 1;
+    long long mark = arbArenaMark();
+    uint32_t* n = arbScratch(len);
+    arbToDigits(one, n, len);
+    //Trial division by 2 and the odd numbers below 2^16
+    for(uint32_t d = 2;d < 65536;d += d == 2 ? 1 : 2) {
+        if(digitIsZero(n, len - 1) && n[len - 1] < d * d) break;
+        while(digitModSmall(n, len, d) == 0) {
+            digitDivSmall(n, len, d);
+            if(*count == size - 1) out = recalloc(out, &size, 16, sizeof(Arb));
+            out[(*count)++] = intToArb(d, one.accu);
+        }
+    }
+    if(!(digitIsZero(n, len - 1) && n[len - 1] <= 1)) pending[pendingCount++] = digitsToArb(n, len, one.accu);
+    arbArenaRelease(mark);
+    //The rest are split with Pollard's rho until every part is prime
+    int leftoverCount = 0, leftoverSize = 4;
+    Arb* leftovers = calloc(leftoverSize, sizeof(Arb));
+    if(leftovers == NULL) {
+        for(int i = 0;i < *count;i++) freeArb(out[i]);
+        for(int i = 0;i < pendingCount;i++) freeArb(pending[i]);
+        free(out);
+        free(pending);
+        error(mallocError);
+        return NULL;
+    }
+    while(pendingCount != 0) {
+        Arb c = pending[--pendingCount];
+        if(arbIsPrime(c)) {
+            if(*count == size - 1) out = recalloc(out, &size, 16, sizeof(Arb));
+            out[(*count)++] = c;
+            continue;
+        }
+        Arb factor = arbRhoFactor(c);
+        if(arbIsZero(factor)) {
+            freeArb(factor);
+            if(leftoverCount == leftoverSize - 1) leftovers = recalloc(leftovers, &leftoverSize, 4, sizeof(Arb));
+            leftovers[leftoverCount++] = c;
+            continue;
+        }
+        Arb quotient;
+        freeArb(arbIntDivMod(c, factor, &quotient));
+        freeArb(c);
+        if(pendingCount + 2 >= pendingSize) pending = recalloc(pending, &pendingSize, 4, sizeof(Arb));
+        pending[pendingCount++] = factor;
+        pending[pendingCount++] = quotient;
+    }
+    free(pending);
+    qsort(out, *count, sizeof(Arb), &arbCmpValue);
+    *primeCount = *count;
+    for(int i = 0;i < leftoverCount;i++) {
+        if(*count == size - 1) out = recalloc(out, &size, 16, sizeof(Arb));
+        out[(*count)++] = leftovers[i];
+    }
+    free(leftovers);
+    return out;
+}
+#pragma endregion
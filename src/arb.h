@@ -1,45 +1,219 @@
 #ifndef ARB_H
 #define ARB_H 1
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
 typedef struct ArbStruct Arb;
+typedef struct BallStruct Ball;
+typedef struct DoubleDoubleStruct DD;
 //Global arbitrary precision accuracy
 extern int globalAccuracy;
 //Global use arbitrary precision
 extern bool useArb;
+//Global use ball arithmetic in accurate mode
+extern bool useBall;
+//Global use double-double arithmetic, for accuracies up to 30 digits
+extern bool useDD;
+//Global use decimal Arbs for base 10 literals in accurate mode
+extern bool useDec;
 //Global arbitrary precision accuracy in base 10
 extern int digitAccuracy;
+typedef enum ArbConstant {
+    arbconst_pi = 0,
+    arbconst_e = 1,
+    arbconst_ln2 = 2,
+    arbconst_ln10 = 3,
+    arbconst_phi = 4,
+    arbconst_count = 5
+} ArbConstant;
+//Number of constant lookups served from the cache, and the number that had to be computed
+extern int arbConstantHits;
+extern int arbConstantComputes;
 ///General Functions
 //Returns the number of digits required to reach accuracy in base
 int getArbDigitCount(int base);
-Arb arbCTR(unsigned char* mant, short len, short exp, char sign, short accu);
+//Returns the number of limbs needed for digits decimal digits, with a guard limb because the leading limb may hold only one bit
+int getArbLimbCount(double digits);
+//Largest exponent of an Arb, small enough that the exponent in bits fits in an int
+#define ARB_MAX_EXP (1 << 25)
+Arb arbCTR(uint32_t* mant, int len, int exp, char sign, int accu);
+//Number of mantissas allocated and freed with freeArb, and the number of times the scratch arena has grown, counted per thread
+extern _Thread_local long long arbAllocCount;
+extern _Thread_local long long arbFreeCount;
+extern _Thread_local long long arbArenaGrowCount;
+//Allocates a zeroed mantissa of len digits
+uint32_t* arbAlloc(int len);
+//Returns zeroed temporary digits from the arena, which are valid until arbArenaRelease is called with an earlier mark
+uint32_t* arbScratch(int len);
+long long arbArenaMark();
+void arbArenaRelease(long long mark);
+//Frees all but the largest arena block, nothing may be using the arena
+void arbArenaReset();
+//Returns a zero with room for accu digits, for use as the destination of the _into functions
+Arb arbBuffer(int accu);
+//arbBuffer in the arena, it is released with the rest of the arena
+Arb arbScratchBuffer(int accu);
 Arb copyArb(Arb arb);
+//Returns a copy of one rounded to accu digits
+Arb arbWithAccu(Arb one, int accu);
+//Returns 2^power
+Arb arbPow2(int power, int accu);
 void freeArb(Arb arb);
+//Returns whether one is zero, a missing mantissa counts as zero
+bool arbIsZero(Arb one);
 //Returns 1 if one>two, -1 if two>one, or 0 if they are equal
 int arbCmp(Arb one, Arb two);
-//Trim the zeroes and round up if len is greater than accu
+//Trim the zeroes and round up if len is greater than accu, and check the exponent range
 void trimZeroes(Arb* arb);
 //Arb conversions
 Arb parseArb(char* string, int base, int accu);
 double arbToDouble(Arb arb);
+//Conversions to and from double-double, arbToDD rounds to 106 bits
+DD arbToDD(Arb arb);
+Arb ddToArb(DD dd, int accu);
 char* arbToString(Arb arb, int base, int digitAccuracy);
+//Writes digitCount digits of arb to file without building the string, returns the number of digits written
+long long arbWriteDigits(Arb arb, int base, int digitCount, FILE* file);
 Arb doubleToArb(double val, int accu);
+//dst needs room for three digits
+void doubleToArb_into(Arb* dst, double val);
+Arb intToArb(long long val, int accu);
+///Threads
+//Largest number of threads in the pool
+#define ARB_MAX_THREADS 64
+//Number of threads used for large products and conversions, 0 uses one per core
+extern int arbThreadCount;
+//Operands with at least this many digits are split over the threads
+extern int arbParallelThreshold;
+//Sets arbThreadCount, the pool is stopped and restarts with the new count when it is next needed
+void arbSetThreadCount(int count);
+//Returns the number of threads that are used
+int arbActiveThreads();
+///Multiplication kernels
+//Thresholds (in digits of the shorter factor) where arb_mult switches to a faster algorithm
+extern int karatsubaThreshold;
+extern int toomThreshold;
+extern int nttThreshold;
+//Multiplies the big-endian digit arrays a and b into out, which has a length of aLen+bLen
+void digitMult(const uint32_t* a, int aLen, const uint32_t* b, int bLen, uint32_t* out);
+void digitMultSchool(const uint32_t* a, int aLen, const uint32_t* b, int bLen, uint32_t* out);
+void digitMultDigit(const uint32_t* a, int aLen, uint32_t b, uint32_t* out);
+//Square products of up to ARB_FIXED_MAX digits use unrolled kernels, and smaller intermediates stay on the stack
+#define ARB_FIXED_MAX 16
+extern void (*const digitMultFixed[ARB_FIXED_MAX + 1])(const uint32_t* a, const uint32_t* b, uint32_t* out);
+//Requires (aLen+1)/2 < bLen <= aLen
+void digitMultKaratsuba(const uint32_t* a, int aLen, const uint32_t* b, int bLen, uint32_t* out);
+//Requires 2*ceil(aLen/3) < bLen <= aLen
+void digitMultToom3(const uint32_t* a, int aLen, const uint32_t* b, int bLen, uint32_t* out);
+void digitMultNTT(const uint32_t* a, int aLen, const uint32_t* b, int bLen, uint32_t* out);
 //Math functions
-Arb arb_divModInt(Arb one, unsigned char two, int* carryOut);
+Arb arb_divModInt(Arb one, uint32_t two, int* carryOut);
 Arb multByInt(Arb one, int two);
+//Returns one/two rounded to one.accu digits
+Arb arbDivInt(Arb one, uint32_t two);
 Arb arb_floor(Arb one);
 Arb arb_add(Arb one, Arb two);
 Arb arb_subtract(Arb one, Arb two);
 Arb arb_mult(Arb one, Arb two);
+//Destination versions, the result is rounded to dst->accu digits and dst may also be an argument
+void arb_add_into(Arb* dst, Arb one, Arb two);
+void arb_subtract_into(Arb* dst, Arb one, Arb two);
+void arb_mult_into(Arb* dst, Arb one, Arb two);
+void arb_set_into(Arb* dst, Arb src);
 //Calculate the reciprocal of one
 Arb arb_recip(Arb one);
+Arb arb_divide(Arb one, Arb two);
+//Returns a constant rounded to accu digits, computing it only if the cache is less accurate
+Arb getArbConstant(ArbConstant id, int accu);
+//Frees the cached constants, radix powers and the scratch arena, and stops the thread pool
+void freeArbCaches();
 //Calculate pi to accu digits
 Arb arb_pi(int accu);
 //Calculate e to accu digits
 Arb arb_e(int accu);
+//Largest n where n! is computed with a product tree, larger factorials use the gamma function
+extern int factorialTreeLimit;
 //Calculate the integer factorial of one
 Arb arb_intFact(Arb one);
+Arb arb_gamma(Arb one);
+//Returns gamma(one+1), which is one! for integers
+Arb arb_fact(Arb one);
 Arb arb_exp(Arb one);
+//Returns ln(|one|)
 Arb arb_ln(Arb one);
 Arb arb_pow(Arb one, Arb two);
 Arb arb_sinh(Arb one);
+//Sets sinOut and cosOut (either may be NULL) to sin(one) and cos(one), reducing one by multiples of pi/2
+void arbSinCos(Arb one, Arb* sinOut, Arb* cosOut);
+Arb arb_sin(Arb one);
+Arb arb_cos(Arb one);
+Arb arb_tan(Arb one);
+Arb arb_atan(Arb one);
+Arb arb_asin(Arb one);
+Arb arb_acos(Arb one);
+Arb arb_sqrt(Arb one);
+//Returns the nth root of one, negative values only have odd roots
+Arb arb_root(Arb one, int n);
+///Decimal limbs
+//Decimal Arbs have digits in base ARB_DEC_BASE, so they are parsed and printed in linear time
+#define ARB_DEC_BASE 1000000000
+//Thresholds where decimal products switch to Karatsuba and the NTT, there is no decimal Toom-3
+extern int decKaratsubaThreshold;
+extern int decNTTThreshold;
+//Number of decimal digits with the accuracy of globalAccuracy binary digits
+int getDecAccuracy();
+//trimZeroes for decimal Arbs
+void trimDec(Arb* dec);
+Arb parseDec(char* string, int accu);
+//Prints digitCount significant digits, rounded half up
+char* decToString(Arb dec, int digitCount);
+//decToString streamed to file, returns the number of digits written
+long long decWriteDigits(Arb dec, int digitCount, FILE* file);
+Arb decToArb(Arb dec, int accu);
+double decToDouble(Arb dec);
+Arb dec_add(Arb one, Arb two);
+Arb dec_subtract(Arb one, Arb two);
+Arb dec_mult(Arb one, Arb two);
+//digitMult for base 10^9 digits
+void decMult(const uint32_t* a, int aLen, const uint32_t* b, int bLen, uint32_t* out);
+///Ball arithmetic
+//Returns a ball around mid with a radius of ulps units in its last digit
+Ball arbToBall(Arb mid, int ulps);
+Ball copyBall(Ball one);
+//Parses a literal, which is exact if it fits in accu digits
+Ball parseBall(char* string, int base, int accu);
+//Number of significant digits in base that are guaranteed by the radius, INT32_MAX for exact balls
+int ballDigits(Ball one, int base);
+//Prints the digits of the midpoint that are guaranteed by the radius, at most digitCount
+char* ballToString(Ball one, int base, int digitCount);
+//Upper and lower bounds of log2(|one|)
+double arbLog2Up(Arb one);
+double arbLog2Down(Arb one);
+Ball ball_add(Ball one, Ball two);
+Ball ball_subtract(Ball one, Ball two);
+Ball ball_mult(Ball one, Ball two);
+Ball ball_divide(Ball one, Ball two);
+Ball ball_pow(Ball one, Ball two);
+Ball ball_sqrt(Ball one);
+Ball ball_exp(Ball one);
+Ball ball_ln(Ball one);
+Ball ball_sin(Ball one);
+Ball ball_cos(Ball one);
+Ball ball_tan(Ball one);
+Ball ball_atan(Ball one);
+///Number theory, on the integer parts of the arguments
+//Largest number of steps Pollard's rho takes on a cofactor before giving up
+extern int pollardStepLimit;
+//Miller-Rabin test of |one|, deterministic below 3.3*10^24
+bool arbIsPrime(Arb one);
+//Returns |one| mod |two| and sets quotient to the integer part of |one|/|two| if it is not NULL
+Arb arbIntDivMod(Arb one, Arb two, Arb* quotient);
+//Returns one mod |two|, which is never negative
+Arb arbIntMod(Arb one, Arb two);
+Arb arb_gcd(Arb one, Arb two);
+//Returns base^power mod |mod|, with Montgomery multiplication for odd moduli
+Arb arb_modpow(Arb base, Arb power, Arb mod);
+//Returns the prime factors of |one| in ascending order, found by trial division and Pollard's rho
+//The first primeCount are prime, the rest are composites that could not be split
+Arb* arb_factor(Arb one, int* count, int* primeCount);
 #endif
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "parser.h"
 #include "arb.h"
 #include "misc.h"
+#include <time.h>
 //Header files for all of these functions are in general.h
 int historySize = 0;
 int historyCount = 0;
@@ -27,7 +28,123 @@ char* appendToHistory(Value num, double base, bool print) {
         return out;
     }
 }
+//Writes val to file, Arbs are streamed so that their digits are never held in memory at once
+long long writeValueToFile(Value val, FILE* file) {
+    int digitCount = getArbDigitCount(10);
+    if(val.type == value_arb && val.numArb->r.mantissa != NULL) {
+        long long digits = arbWriteDigits(val.numArb->r, 10, digitCount, file);
+        Arb imag = val.numArb->i;
+        if(imag.mantissa != NULL && !arbIsZero(imag)) {
+            fputs(imag.sign == 1 ? " - " : " + ", file);
+            imag.sign = 0;
+            digits += arbWriteDigits(imag, 10, digitCount, file);
+            fputc('i', file);
+        }
+        return digits;
+    }
+    if(val.type == value_dec && val.numArb->r.mantissa != NULL) return decWriteDigits(val.numArb->r, digitCount, file);
+    if(val.type == value_ball) {
+        //Only the guaranteed digits of the midpoint are written
+        int guaranteed = ballDigits(val.numBall->b, 10);
+        if(guaranteed > 0) return arbWriteDigits(val.numBall->b.mid, 10, guaranteed < digitCount ? guaranteed : digitCount, file);
+    }
+    char* string = valueToString(val, 10);
+    fputs(string, file);
+    long long length = strlen(string);
+    free(string);
+    return length;
+}
 //Header file for runCommand is in general.h
+//Lists the prime factors of an integer value with arbitrary precision
+char* arbFactorString(Value val) {
+    Arb n;
+    if(!getArbInteger(val, "-factors", &n)) return calloc(1, 1);
+    int digitCount = (n.exp + 1) * 10 + 1;
+    char* nString = arbToString(n, 10, digitCount);
+    int count, primeCount;
+    Arb* factors = arb_factor(n, &count, &primeCount);
+    freeArb(n);
+    if(factors == NULL) {
+        free(nString);
+        return calloc(1, 1);
+    }
+    int outSize = strlen(nString) + 50;
+    char* out = calloc(outSize, 1);
+    if(count == 0) snprintf(out, outSize, "%s has no prime factors", nString);
+    else if(count == 1 && primeCount == 1) snprintf(out, outSize, "%s is prime", nString);
+    else {
+        snprintf(out, outSize, "Factors of %s:", nString);
+        int outPos = strlen(out);
+        int prefixLen = outPos;
+        for(int i = 0;i < count;i++) {
+            //Repeated primes are written as powers
+            int power = 1;
+            while(i + 1 < primeCount && arbCmp(factors[i], factors[i + 1]) == 0) {
+                freeArb(factors[i++]);
+                power++;
+            }
+            char* factorString = arbToString(factors[i], 10, digitCount);
+            freeArb(factors[i]);
+            int length = strlen(factorString) + 30;
+            if(outPos + length >= outSize) {
+                outSize += length + 200;
+                out = realloc(out, outSize);
+            }
+            char* separator = outPos == prefixLen ? "" : " *";
+            if(i >= primeCount) snprintf(out + outPos, outSize - outPos, "%s %s (composite)", separator, factorString);
+            else if(power != 1) snprintf(out + outPos, outSize - outPos, "%s %s^%d", separator, factorString, power);
+            else snprintf(out + outPos, outSize - outPos, "%s %s", separator, factorString);
+            outPos += strlen(out + outPos);
+            free(factorString);
+        }
+    }
+    free(factors);
+    free(nString);
+    return out;
+}
+double wallSeconds() {
+    struct timespec now;
+    timespec_get(&now, TIME_UTC);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+//Times a product and a conversion to decimal of random Arbs with digits digits, from one thread up to the current setting
+char* benchmarkThreads(int digits) {
+    int len = digits * log(10) / log(4294967296.0) + 1;
+    Arb one = arbCTR(arbAlloc(len + 1), len, len - 1, 0, len);
+    Arb two = arbCTR(arbAlloc(len + 1), len, len - 1, 0, len);
+    for(int i = 0;i < len;i++) {
+        one.mantissa[i] = (uint32_t)rand() << 16 ^ rand();
+        two.mantissa[i] = (uint32_t)rand() << 16 ^ rand();
+    }
+    one.mantissa[0] |= 1;
+    two.mantissa[0] |= 1;
+    int oldThreads = arbThreadCount, maxThreads = arbActiveThreads();
+    int outSize = 200 + 60 * 8;
+    char* out = calloc(outSize, 1);
+    snprintf(out, outSize, "%d digit operands\n%-9s %11s %6s %11s", digits, "Threads", "Multiply", "", "Convert");
+    double multBase = 0, convertBase = 0;
+    for(int threads = 1;threads <= maxThreads;threads = threads * 2 > maxThreads && threads != maxThreads ? maxThreads : threads * 2) {
+        arbSetThreadCount(threads);
+        double start = wallSeconds();
+        Arb product = arb_mult(one, two);
+        double mult = wallSeconds() - start;
+        start = wallSeconds();
+        char* string = arbToString(one, 10, digits);
+        double convert = wallSeconds() - start;
+        freeArb(product);
+        free(string);
+        if(threads == 1) {
+            multBase = mult;
+            convertBase = convert;
+        }
+        int outPos = strlen(out);
+        snprintf(out + outPos, outSize - outPos, "\n%-9d %8.1f ms %5.2fx %8.1f ms %5.2fx", threads, mult * 1000, multBase / mult, convert * 1000, convertBase / convert);
+    }
+    arbSetThreadCount(oldThreads);
+    freeArb(one);
+    freeArb(two);
+    return out;
+}
 char* runCommand(char* input) {
     if(startsWith(input, "-ls")) {
         char* type = input + 4;
@@ -245,31 +362,164 @@ char* runCommand(char* input) {
     }
     else if(startsWith(input, "-setaccu")) {
         useArb = false;
+        useDD = false;
         Value accu = calculate(input + 9, 10);
         double accuR = getR(accu);
         freeValue(accu);
-        globalAccuracy = ((accuR + 5) * log(10) / log(256));
+        globalAccuracy = accuR > 1262596 ? 131073 : getArbLimbCount(accuR);
         digitAccuracy = accuR;
         if(accuR < 11) {
+            //Cached constants are extended lazily when the accuracy is raised, so they are only released here
+            freeArbCaches();
             char* out = calloc(25, 1);
             strcpy(out, "Exited accurate mode.");
             return out;
         }
-        else useArb = true;
+        //Up to 30 digits fit in a double-double, which is much faster than an Arb
+        if(accuR <= 30) {
+            useDD = true;
+            char* out = calloc(200, 1);
+            snprintf(out, 200, "Accuracy set to %d decimal digits, using double-double arithmetic.\nTo go back to normal mode, type \"-setaccu 0\".", (int)accuR);
+            return out;
+        }
+        useArb = true;
         char* out = calloc(300, 1);
-        if(globalAccuracy > 30000) {
-            strcat(out, "Warning: Accuracy has been capped at 60000 hexadecimal digits.\n");
-            globalAccuracy = 30000;
-            digitAccuracy = 72244;
+        if(globalAccuracy > 131072) {
+            strcat(out, "Warning: Accuracy has been capped at 1048576 hexadecimal digits.\n");
+            globalAccuracy = 131072;
+            digitAccuracy = 1262596;
         }
-        else snprintf(out + strlen(out), 150, "Accuracy set to %d hexadecimal digits\n", globalAccuracy * 2);
+        else snprintf(out + strlen(out), 150, "Accuracy set to %d hexadecimal digits\n", globalAccuracy * 8);
         strcat(out, "Warning: this feature is experimental and may not be accurate. Some features are not implemented. To go back to normal mode, type \"-setaccu 0\".");
         return out;
     }
+    else if(startsWith(input, "-setball")) {
+        char* out = calloc(120, 1);
+        if(startsWith(input + 9, "on")) useBall = true;
+        else if(startsWith(input + 9, "off")) useBall = false;
+        else {
+            error("expected on or off");
+            return out;
+        }
+        if(!useBall) strcpy(out, "Ball arithmetic disabled.");
+        else if(useArb) strcpy(out, "Ball arithmetic enabled, results only show guaranteed digits.");
+        else strcpy(out, "Ball arithmetic enabled, it takes effect in accurate mode (see -setaccu).");
+        return out;
+    }
+    else if(startsWith(input, "-setdecimal")) {
+        char* out = calloc(120, 1);
+        if(startsWith(input + 12, "on")) useDec = true;
+        else if(startsWith(input + 12, "off")) useDec = false;
+        else {
+            error("expected on or off");
+            return out;
+        }
+        if(!useDec) strcpy(out, "Decimal mode disabled.");
+        else if(useArb) strcpy(out, "Decimal mode enabled, base 10 numbers are stored in decimal digits.");
+        else strcpy(out, "Decimal mode enabled, it takes effect in accurate mode (see -setaccu).");
+        return out;
+    }
+    else if(startsWith(input, "-exact")) {
+        //format: -exact 50 sin(1e30) will print 50 digits of sin(1e30)
+        int i, expStart = 0;
+        for(i = 7;i < strlen(input);i++) if(input[i] == ' ') {
+            expStart = i + 1;
+            input[i] = '\0';
+            break;
+        }
+        bool oldUseArb = useArb, oldUseDD = useDD;
+        int oldAccuracy = globalAccuracy, oldDigits = digitAccuracy;
+        useArb = false;
+        useDD = false;
+        Value digitsVal = calculate(input + 7, 10);
+        int digits = getR(digitsVal);
+        freeValue(digitsVal);
+        if(globalError || expStart == 0 || digits < 1 || digits > 1262596) {
+            useArb = oldUseArb;
+            useDD = oldUseDD;
+            if(!globalError) error("expected -exact {digits} {expression}, with up to 1262596 digits");
+            return calloc(1, 1);
+        }
+        //Start with a few guard digits, and double the accuracy until two rounds print the same digits
+        useArb = true;
+        digitAccuracy = digits;
+        int limbs = getArbLimbCount(digits);
+        //Results such as zero never stabilise, so give up after six doublings
+        int maxLimbs = limbs * 64 > 131072 ? 131072 : limbs * 64;
+        char* prev = NULL;
+        Value out = NULLVAL;
+        bool stable = false;
+        while(true) {
+            globalAccuracy = limbs;
+            out = calculate(input + expStart, 10);
+            if(globalError) break;
+            //Balls know their own error, so they only need one round
+            if(out.type == value_ball && ballDigits(out.numBall->b, 10) >= digits) {
+                stable = true;
+                break;
+            }
+            char* current = valueToString(out, 10);
+            stable = prev != NULL && strcmp(prev, current) == 0;
+            free(prev);
+            prev = current;
+            if(stable || limbs * 2 > maxLimbs) break;
+            freeValue(out);
+            limbs *= 2;
+        }
+        free(prev);
+        char* ans = NULL;
+        if(!globalError) {
+            ans = appendToHistory(out, 10, false);
+            if(!stable) {
+                char* warned = calloc(strlen(ans) + 60, 1);
+                snprintf(warned, strlen(ans) + 60, "Warning: the digits did not stabilise.\n%s", ans);
+                free(ans);
+                ans = warned;
+            }
+        }
+        useArb = oldUseArb;
+        useDD = oldUseDD;
+        globalAccuracy = oldAccuracy;
+        digitAccuracy = oldDigits;
+        return ans == NULL ? calloc(1, 1) : ans;
+    }
+    else if(startsWith(input, "-threads")) {
+        //format: -threads 4, -threads bench 200000, or -threads to show the current setting
+        if(startsWith(input + 9, "bench")) {
+            int digits = 200000;
+            if(strlen(input) > 15) {
+                Value digitsVal = calculate(input + 15, 10);
+                digits = getR(digitsVal);
+                freeValue(digitsVal);
+                if(globalError) return calloc(1, 1);
+            }
+            if(digits < 1000 || digits > 10000000) {
+                error("the benchmark requires between 1000 and 10000000 digits");
+                return calloc(1, 1);
+            }
+            return benchmarkThreads(digits);
+        }
+        if(strlen(input) > 9) {
+            Value countVal = calculate(input + 9, 10);
+            double count = getR(countVal);
+            freeValue(countVal);
+            if(globalError) return calloc(1, 1);
+            if(count < 0 || count > ARB_MAX_THREADS) {
+                error("the number of threads must be between 0 and %d", ARB_MAX_THREADS);
+                return calloc(1, 1);
+            }
+            arbSetThreadCount(count);
+        }
+        char* out = calloc(100, 1);
+        int threads = arbActiveThreads();
+        snprintf(out, 100, "Using %d %s%s.", threads, threads == 1 ? "thread" : "threads", arbThreadCount == 0 ? ", one per core" : "");
+        return out;
+    }
     else if(startsWith(input, "-getaccu")) {
         char* out = calloc(70, 1);
-        if(!useArb) strcpy(out, "Currently not in accurate mode (13 hexadecimal digits).");
-        else snprintf(out, 70, "Current accuracy is %d hexadecimal digits.", globalAccuracy);
+        if(useDD) snprintf(out, 70, "Current accuracy is %d decimal digits (double-double).", digitAccuracy);
+        else if(!useArb) strcpy(out, "Currently not in accurate mode (13 hexadecimal digits).");
+        else snprintf(out, 70, "Current accuracy is %d hexadecimal digits.", globalAccuracy * 8);
         return out;
     }
     else if(startsWith(input, "-base")) {
@@ -296,11 +546,14 @@ char* runCommand(char* input) {
     else if(startsWith(input, "-factors") || startsWith(input, "-factor")) {
         char* expression = input[7] == 's' ? input + 9 : input + 8;
         Value val = calculate(expression, 0);
+        //Arbitrary-precision integers and integers past 32 bits use Pollard's rho
+        if(val.type == value_arb || fabs(getR(val)) > 2147483647) {
+            char* out = arbFactorString(val);
+            freeValue(val);
+            return out;
+        }
         double num = getR(val);
         freeValue(val);
-        if(num > 2147483647 || num < -2147483647) {
-            error("%g is out of bounds", num);
-        }
         int* factors = primeFactors((int)num);
         //If num is prime
         if(factors[0] == 0) {
@@ -339,6 +592,41 @@ char* runCommand(char* input) {
             return out;
         }
     }
+    else if(startsWith(input, "-export")) {
+        //The file name is the first word, the rest is the expression
+        char* nameStart = input + 8;
+        char* space = strchr(nameStart, ' ');
+        if(space == NULL || space == nameStart) {
+            error("-export requires a file name and an expression");
+            return calloc(1, 1);
+        }
+        char fileName[space - nameStart + 1];
+        memcpy(fileName, nameStart, space - nameStart);
+        fileName[space - nameStart] = '\0';
+        Value val = calculate(space + 1, 0);
+        if(globalError) return calloc(1, 1);
+        FILE* file = fopen(fileName, "w");
+        if(file == NULL) {
+            error("could not open %s", fileName);
+            freeValue(val);
+            return calloc(1, 1);
+        }
+        setvbuf(file, NULL, _IOFBF, 1 << 20);
+        long long digits = writeValueToFile(val, file);
+        fputc('\n', file);
+        bool failed = ferror(file);
+        if(fclose(file) != 0 || failed) {
+            error("could not write to %s", fileName);
+            freeValue(val);
+            return calloc(1, 1);
+        }
+        //The value is kept in the history, but never converted to a string
+        if(historySize - 1 == historyCount) history = recalloc(history, &historySize, 25, sizeof(Value));
+        history[historyCount++] = val;
+        char* out = calloc(strlen(fileName) + 60, 1);
+        snprintf(out, strlen(fileName) + 60, "Wrote %lld digits of $%d to %s", digits, historyCount - 1, fileName);
+        return out;
+    }
     else if(startsWith(input, "-ratio")) {
         Value val = calculate(input + 7, 0);
         //If out is a number
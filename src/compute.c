@@ -2,6 +2,7 @@
 #include "general.h"
 #include "functions.h"
 #include "parser.h"
+#include "arb.h"
 #include <math.h>
 #include <string.h>
 #pragma region Numbers
@@ -242,6 +243,160 @@ Number compBinRs(Number one, Number two) {
     return one;
 }
 #pragma endregion
+#pragma region Double-Double
+//Constants split into two or three doubles
+const double ddPi[2] = { 3.1415926535897931, 1.2246467991473532e-16 };
+const double ddHalfPi[3] = { 1.5707963267948966, 6.123233995736766e-17, -1.4973849048591698e-33 };
+const double ddLn2[2] = { 0.69314718055994529, 2.3190468138462996e-17 };
+DD newDD(double hi, double lo) {
+    DD out;
+    out.hi = hi;
+    out.lo = lo;
+    return out;
+}
+//Error-free transformations, the results are exactly a+b and a*b
+DD twoSum(double a, double b) {
+    double s = a + b;
+    double bb = s - a;
+    return newDD(s, (a - (s - bb)) + (b - bb));
+}
+//twoSum for |a| >= |b|
+DD quickTwoSum(double a, double b) {
+    double s = a + b;
+    return newDD(s, b - (s - a));
+}
+DD twoProd(double a, double b) {
+    double p = a * b;
+    return newDD(p, fma(a, b, -p));
+}
+DD ddAdd(DD one, DD two) {
+    //Both components are added separately, so cancellation in the high parts keeps the low parts
+    DD s = twoSum(one.hi, two.hi);
+    DD t = twoSum(one.lo, two.lo);
+    s = quickTwoSum(s.hi, s.lo + t.hi);
+    return quickTwoSum(s.hi, s.lo + t.lo);
+}
+DD ddNegate(DD one) {
+    return newDD(-one.hi, -one.lo);
+}
+DD ddSubtract(DD one, DD two) {
+    return ddAdd(one, ddNegate(two));
+}
+DD ddMultDouble(DD one, double two) {
+    DD p = twoProd(one.hi, two);
+    return quickTwoSum(p.hi, p.lo + one.lo * two);
+}
+DD ddMult(DD one, DD two) {
+    DD p = twoProd(one.hi, two.hi);
+    return quickTwoSum(p.hi, p.lo + (one.hi * two.lo + one.lo * two.hi));
+}
+DD ddDivide(DD one, DD two) {
+    if(two.hi == 0) return newDD(one.hi / two.hi, 0);
+    //Long division with three double quotients
+    double q1 = one.hi / two.hi;
+    DD rem = ddSubtract(one, ddMultDouble(two, q1));
+    double q2 = rem.hi / two.hi;
+    rem = ddSubtract(rem, ddMultDouble(two, q2));
+    double q3 = rem.hi / two.hi;
+    DD q = quickTwoSum(q1, q2);
+    return ddAdd(q, newDD(q3, 0));
+}
+DD ddSqrt(DD one) {
+    if(one.hi <= 0) return newDD(sqrt(one.hi), 0);
+    //One Newton step from the double root, y + (one - y^2) / 2y
+    double y = sqrt(one.hi);
+    DD diff = ddSubtract(one, twoProd(y, y));
+    return quickTwoSum(y, diff.hi / (2 * y));
+}
+DD ddExp(DD one) {
+    if(one.hi > 709.79) return newDD(INFINITY, 0);
+    if(one.hi < -745.2) return newDD(0, 0);
+    //exp(one) = 2^k * exp(r)^512 where one = k*ln2 + 512r
+    double k = floor(one.hi / ddLn2[0] + 0.5);
+    DD r = ddSubtract(one, ddMultDouble(newDD(ddLn2[0], ddLn2[1]), k));
+    r = newDD(ldexp(r.hi, -9), ldexp(r.lo, -9));
+    //Taylor series of exp(r)-1, |r| < 0.0007 so ten terms reach 106 bits
+    DD sum = r;
+    DD term = r;
+    for(int n = 2;n <= 10;n++) {
+        term = ddDivide(ddMult(term, r), newDD(n, 0));
+        sum = ddAdd(sum, term);
+    }
+    //Square 9 times, (1+s)^2-1 = 2s+s^2 keeps the precision of the small sum
+    for(int i = 0;i < 9;i++) sum = ddAdd(ddMultDouble(sum, 2), ddMult(sum, sum));
+    sum = ddAdd(sum, newDD(1, 0));
+    return newDD(ldexp(sum.hi, (int)k), ldexp(sum.lo, (int)k));
+}
+DD ddLn(DD one) {
+    if(one.hi <= 0) return newDD(log(one.hi), 0);
+    //One Newton step from the double logarithm, y + one*exp(-y) - 1
+    DD y = newDD(log(one.hi), 0);
+    DD scaled = ddMult(one, ddExp(ddNegate(y)));
+    return ddAdd(y, ddSubtract(scaled, newDD(1, 0)));
+}
+//Sets sinOut and cosOut to sin(one) and cos(one), which is accurate while |one| < 2^20
+void ddSinCos(DD one, DD* sinOut, DD* cosOut) {
+    //Reduce by k*pi/2 with pi/2 in three parts, so k*pi/2 is exact to about 150 bits
+    double k = floor(one.hi / ddHalfPi[0] + 0.5);
+    DD r = ddSubtract(one, twoProd(k, ddHalfPi[0]));
+    r = ddSubtract(r, twoProd(k, ddHalfPi[1]));
+    r = ddSubtract(r, newDD(k * ddHalfPi[2], 0));
+    //Taylor series for |r| <= pi/4
+    DD square = ddNegate(ddMult(r, r));
+    DD sinSum = r, cosSum = newDD(1, 0);
+    DD sinTerm = sinSum, cosTerm = cosSum;
+    for(int n = 1;n <= 14;n++) {
+        sinTerm = ddDivide(ddMult(sinTerm, square), newDD(2.0 * n * (2 * n + 1), 0));
+        cosTerm = ddDivide(ddMult(cosTerm, square), newDD(2.0 * n * (2 * n - 1), 0));
+        sinSum = ddAdd(sinSum, sinTerm);
+        cosSum = ddAdd(cosSum, cosTerm);
+    }
+    int quadrant = (long long)k & 3;
+    DD sinQ[4] = { sinSum,cosSum,ddNegate(sinSum),ddNegate(cosSum) };
+    DD cosQ[4] = { cosSum,ddNegate(sinSum),ddNegate(cosSum),sinSum };
+    if(sinOut != NULL) *sinOut = sinQ[quadrant];
+    if(cosOut != NULL) *cosOut = cosQ[quadrant];
+}
+DD ddSin(DD one) {
+    DD out;
+    ddSinCos(one, &out, NULL);
+    return out;
+}
+DD ddCos(DD one) {
+    DD out;
+    ddSinCos(one, NULL, &out);
+    return out;
+}
+DD ddTan(DD one) {
+    DD sine, cosine;
+    ddSinCos(one, &sine, &cosine);
+    return ddDivide(sine, cosine);
+}
+DD ddAtan(DD one) {
+    //One Newton step from the double arctangent, y + (one*cos(y) - sin(y)) * cos(y)
+    DD y = newDD(atan(one.hi), 0);
+    DD sine, cosine;
+    ddSinCos(y, &sine, &cosine);
+    DD diff = ddSubtract(ddMult(one, cosine), sine);
+    return ddAdd(y, ddMult(diff, cosine));
+}
+DD ddPower(DD one, DD two) {
+    //Integer powers use repeated squaring
+    if(two.lo == 0 && two.hi == floor(two.hi) && fabs(two.hi) < 2147483648.0) {
+        long long n = fabs(two.hi);
+        DD out = newDD(1, 0);
+        DD square = one;
+        while(n != 0) {
+            if(n & 1) out = ddMult(out, square);
+            n >>= 1;
+            if(n != 0) square = ddMult(square, square);
+        }
+        if(two.hi < 0) out = ddDivide(newDD(1, 0), out);
+        return out;
+    }
+    return ddExp(ddMult(two, ddLn(one)));
+}
+#pragma endregion
 #pragma region Vectors
 void applyUnaryToVector(Value* one, Number func(Number)) {
     if(one->type == value_num) {
@@ -399,8 +554,946 @@ Vector matInv(Vector one) {
     return cofactors;
 }
 #pragma endregion
+#pragma region Arbitrary Precision
+bool arbIsReal(ArbNum num) {
+    return num.i.len == 0 || arbIsZero(num.i);
+}
+//Returns the real component of val as an Arb that must be freed
+Arb getArbR(Value val) {
+    if(val.type == value_arb) {
+        if(!arbIsReal(*val.numArb)) error("complex arbitrary-precision numbers are not supported");
+        return copyArb(val.numArb->r);
+    }
+    if(val.type == value_num) {
+        if(val.i != 0) error("complex arbitrary-precision numbers are not supported");
+        return doubleToArb(val.r, globalAccuracy);
+    }
+    error("Vectors do not have arbitrary precision support.");
+    return intToArb(0, globalAccuracy);
+}
+//Returns val as a complex number whose components must be freed
+ArbNum getArbNum(Value val) {
+    ArbNum out;
+    if(val.type == value_arb) {
+        out = *val.numArb;
+        out.r = out.r.mantissa == NULL ? intToArb(0, globalAccuracy) : copyArb(out.r);
+        out.i = arbIsReal(*val.numArb) ? intToArb(0, out.r.accu) : copyArb(out.i);
+        return out;
+    }
+    if(val.type == value_num) {
+        out.r = doubleToArb(val.r, globalAccuracy);
+        out.i = doubleToArb(val.i, globalAccuracy);
+        out.u = val.u;
+        return out;
+    }
+    if(val.type == value_arbvec) {
+        out = val.vecArb->val[0];
+        out.r = copyArb(out.r);
+        out.i = copyArb(out.i);
+        return out;
+    }
+    error("Vectors do not have arbitrary precision support.");
+    out.r = intToArb(0, globalAccuracy);
+    out.i = intToArb(0, globalAccuracy);
+    out.u = 0;
+    return out;
+}
+void freeArbNum(ArbNum num) {
+    freeArb(num.r);
+    freeArb(num.i);
+}
+//Returns whether one is an integer that fits in 32 bits, which arb_pow raises by repeated squaring
+bool arbIsSmallInt(Arb one) {
+    return arbIsZero(one) || (one.exp == 0 && one.len == 1);
+}
+ArbNum arbNumAdd(ArbNum one, ArbNum two) {
+    ArbNum out;
+    out.r = arb_add(one.r, two.r);
+    out.i = arb_add(one.i, two.i);
+    out.u = 0;
+    return out;
+}
+ArbNum arbNumMult(ArbNum one, ArbNum two) {
+    ArbNum out;
+    out.u = 0;
+    //Real factors only need two products
+    if(arbIsZero(two.i)) {
+        out.r = arb_mult(one.r, two.r);
+        out.i = arb_mult(one.i, two.r);
+        return out;
+    }
+    if(arbIsZero(one.i)) {
+        out.r = arb_mult(one.r, two.r);
+        out.i = arb_mult(one.r, two.i);
+        return out;
+    }
+    //(a+bi)(c+di) = (ac-bd) + (ad+bc)i, Gauss's three product form is avoided as it cancels digits
+    Arb ac = arb_mult(one.r, two.r);
+    Arb bd = arb_mult(one.i, two.i);
+    Arb ad = arb_mult(one.r, two.i);
+    Arb bc = arb_mult(one.i, two.r);
+    out.r = arb_subtract(ac, bd);
+    out.i = arb_add(ad, bc);
+    freeArb(ac);
+    freeArb(bd);
+    freeArb(ad);
+    freeArb(bc);
+    return out;
+}
+ArbNum arbNumDivide(ArbNum one, ArbNum two) {
+    ArbNum out;
+    out.u = 0;
+    int accu = one.r.accu > two.r.accu ? one.r.accu : two.r.accu;
+    if(arbIsZero(two.r) && arbIsZero(two.i)) {
+        error("Division by zero");
+        out.r = intToArb(0, accu);
+        out.i = intToArb(0, accu);
+        return out;
+    }
+    //(a+bi)/(c+di) = (a+bi)(c-di) * 1/(c^2+d^2), so only one reciprocal is needed
+    Arb denominator;
+    ArbNum conjugate = two;
+    if(arbIsZero(two.i)) denominator = arbWithAccu(two.r, accu + 1);
+    else {
+        Arb rr = arb_mult(two.r, two.r);
+        Arb ii = arb_mult(two.i, two.i);
+        denominator = arb_add(rr, ii);
+        denominator.accu = accu + 1;
+        freeArb(rr);
+        freeArb(ii);
+        conjugate.i.sign ^= 1;
+    }
+    Arb recip = arb_recip(denominator);
+    ArbNum numerator = arbIsZero(two.i) ? one : arbNumMult(one, conjugate);
+    out.r = arb_mult(numerator.r, recip);
+    out.i = arb_mult(numerator.i, recip);
+    out.r.accu = out.i.accu = accu;
+    trimZeroes(&out.r);
+    trimZeroes(&out.i);
+    if(!arbIsZero(two.i)) freeArbNum(numerator);
+    freeArb(denominator);
+    freeArb(recip);
+    return out;
+}
+//Principal square root, sqrt(a+bi) = sqrt((|z|+a)/2) + sign(b)*sqrt((|z|-a)/2)i
+ArbNum arbNumSqrt(ArbNum one) {
+    ArbNum out;
+    out.u = 0;
+    int accu = one.r.accu;
+    Arb rr = arb_mult(one.r, one.r);
+    Arb ii = arb_mult(one.i, one.i);
+    Arb normSquared = arb_add(rr, ii);
+    Arb norm = arb_sqrt(normSquared);
+    Arb half = arbPow2(-1, accu);
+    Arb sum = arb_add(norm, one.r);
+    Arb difference = arb_subtract(norm, one.r);
+    Arb halfSum = arb_mult(sum, half);
+    Arb halfDifference = arb_mult(difference, half);
+    //|z| is rounded, so these can be slightly negative when the other is zero
+    if(halfSum.sign == 1) halfSum.sign = 0;
+    if(halfDifference.sign == 1) halfDifference.sign = 0;
+    out.r = arb_sqrt(halfSum);
+    out.i = arb_sqrt(halfDifference);
+    if(one.i.sign == 1 && !arbIsZero(out.i)) out.i.sign = 1;
+    freeArb(rr);
+    freeArb(ii);
+    freeArb(normSquared);
+    freeArb(norm);
+    freeArb(half);
+    freeArb(sum);
+    freeArb(difference);
+    freeArb(halfSum);
+    freeArb(halfDifference);
+    return out;
+}
+ArbNum arbNumPower(ArbNum one, ArbNum two) {
+    ArbNum out;
+    out.u = 0;
+    int accu = one.r.accu > two.r.accu ? one.r.accu : two.r.accu;
+    if(!arbIsZero(two.i)) {
+        error("complex powers are not supported in accurate mode");
+        out.r = intToArb(0, accu);
+        out.i = intToArb(0, accu);
+        return out;
+    }
+    if(arbIsZero(one.i) && (one.r.sign == 0 || arbIsSmallInt(two.r))) {
+        out.r = arb_pow(one.r, two.r);
+        out.i = intToArb(0, accu);
+        return out;
+    }
+    Arb half = arbPow2(-1, accu);
+    bool isRoot = two.r.sign == 0 && arbCmp(two.r, half) == 0;
+    freeArb(half);
+    if(isRoot) return arbNumSqrt(one);
+    if(!arbIsSmallInt(two.r)) {
+        error("complex arbitrary-precision numbers only support integer powers");
+        out.r = intToArb(0, accu);
+        out.i = intToArb(0, accu);
+        return out;
+    }
+    //Repeated squaring, then a reciprocal for negative powers
+    uint32_t power = arbIsZero(two.r) ? 0 : two.r.mantissa[0];
+    ArbNum square = one;
+    square.r = arbWithAccu(one.r, accu + 2);
+    square.i = arbWithAccu(one.i, accu + 2);
+    out.r = intToArb(1, accu + 2);
+    out.i = intToArb(0, accu + 2);
+    while(power != 0) {
+        if(power & 1) {
+            ArbNum product = arbNumMult(out, square);
+            freeArbNum(out);
+            out = product;
+        }
+        power >>= 1;
+        if(power != 0) {
+            ArbNum newSquare = arbNumMult(square, square);
+            freeArbNum(square);
+            square = newSquare;
+        }
+    }
+    freeArbNum(square);
+    if(two.r.sign == 1) {
+        ArbNum unit;
+        unit.r = intToArb(1, accu + 2);
+        unit.i = intToArb(0, accu + 2);
+        ArbNum recip = arbNumDivide(unit, out);
+        freeArbNum(unit);
+        freeArbNum(out);
+        out = recip;
+    }
+    out.r.accu = out.i.accu = accu;
+    trimZeroes(&out.r);
+    trimZeroes(&out.i);
+    return out;
+}
+//Wraps num in a value, dropping a zero imaginary component
+Value newValArbNum(ArbNum num, unit_t unit) {
+    Value out = newValArb(num.r, unit);
+    if(arbIsZero(num.i)) freeArb(num.i);
+    else out.numArb->i = num.i;
+    return out;
+}
+void applyUnaryToArb(Value* one, Arb func(Arb)) {
+    ArbNum* num = one->numArb;
+    if(!arbIsReal(*num)) {
+        error("complex arbitrary-precision numbers are not supported");
+        return;
+    }
+    Arb out = func(num->r);
+    freeArb(num->r);
+    num->r = out;
+}
+void applyArbLn(Value* one) {
+    char sign = one->numArb->r.sign;
+    applyUnaryToArb(one, &arb_ln);
+    if(globalError) return;
+    //ln(-x) = ln(x) + pi*i
+    if(sign == 1) {
+        freeArb(one->numArb->i);
+        one->numArb->i = arb_pi(one->numArb->r.accu);
+    }
+}
+void applyArbLogTen(Value* one) {
+    applyArbLn(one);
+    if(globalError) return;
+    //log10(x) = ln(x) / ln(10)
+    ArbNum* num = one->numArb;
+    Arb ln10 = getArbConstant(arbconst_ln10, num->r.accu);
+    Arb r = arb_divide(num->r, ln10);
+    freeArb(num->r);
+    num->r = r;
+    if(!arbIsReal(*num)) {
+        Arb i = arb_divide(num->i, ln10);
+        freeArb(num->i);
+        num->i = i;
+    }
+    freeArb(ln10);
+}
+//Returns degrat as an Arb, using pi for degrees and gradians so they are not limited to double precision
+Arb getArbDegrat(int accu) {
+    if(degrat == M_PI / 180 || degrat == M_PI / 200) {
+        Arb pi = getArbConstant(arbconst_pi, accu);
+        Arb out = arbDivInt(pi, degrat == M_PI / 180 ? 180 : 200);
+        freeArb(pi);
+        return out;
+    }
+    return doubleToArb(degrat, accu);
+}
+//compTrig for a real Arb
+Arb arbTrig(int type, Arb one) {
+    int accu = one.accu;
+    Arb out;
+    //Trigonometric functions
+    if(type < 21) {
+        //Apply degree ratio
+        Arb x = copyArb(one);
+        if(degrat != 1) {
+            Arb ratio = getArbDegrat(accu + 1);
+            freeArb(x);
+            x = arb_mult(one, ratio);
+            x.accu = accu;
+            trimZeroes(&x);
+            freeArb(ratio);
+        }
+        Arb oneArb = intToArb(1, accu);
+        if(type == op_sin) out = arb_sin(x);
+        else if(type == op_cos) out = arb_cos(x);
+        else if(type == op_tan) out = arb_tan(x);
+        else if(type == op_sinh) out = arb_sinh(x);
+        else if(type == op_cosh || type == op_tanh) {
+            //cosh(x) = (exp(x) + exp(-x)) / 2, tanh(x) = sinh(x) / cosh(x)
+            Arb exp = arb_exp(x);
+            Arb recip = arb_recip(exp);
+            Arb sum = arb_add(exp, recip);
+            Arb cosh = arbDivInt(sum, 2);
+            if(type == op_cosh) out = cosh;
+            else {
+                Arb sinh = arb_sinh(x);
+                out = arb_divide(sinh, cosh);
+                freeArb(sinh);
+                freeArb(cosh);
+            }
+            freeArb(exp);
+            freeArb(recip);
+            freeArb(sum);
+        }
+        // csc, sec, cot
+        else {
+            Arb sin, cos;
+            arbSinCos(x, &sin, &cos);
+            if(type == op_csc) out = arb_divide(oneArb, sin);
+            if(type == op_sec) out = arb_divide(oneArb, cos);
+            if(type == op_cot) out = arb_divide(cos, sin);
+            freeArb(sin);
+            freeArb(cos);
+        }
+        freeArb(x);
+        freeArb(oneArb);
+        return out;
+    }
+    //Inverse trigonometric functions
+    int opID = type;
+    Arb x = copyArb(one);
+    //acsc, asec, acot: invert and change opID
+    if(type == op_acsc || type == op_asec || type == op_acot) {
+        Arb oneArb = intToArb(1, accu);
+        freeArb(x);
+        x = arb_divide(oneArb, one);
+        freeArb(oneArb);
+        opID -= 3;
+    }
+    if(opID == op_asin) out = arb_asin(x);
+    else if(opID == op_acos) out = arb_acos(x);
+    else if(opID == op_atan) out = arb_atan(x);
+    else {
+        //asinh(x) = ln(x + sqrt(x^2 + 1)), acosh(x) = ln(x + sqrt(x^2 - 1)), atanh(x) = ln((1 + x) / (1 - x)) / 2
+        Arb oneArb = intToArb(1, accu);
+        char sign = x.sign;
+        if(opID == op_asinh) x.sign = 0;
+        Arb square = arb_mult(x, x);
+        Arb inner = opID == op_asinh ? arb_add(square, oneArb) : arb_subtract(square, oneArb);
+        Arb above = arb_add(oneArb, x);
+        Arb below = arb_subtract(oneArb, x);
+        Arb lnArg;
+        if(opID == op_atanh) {
+            if(below.sign == 1 || arbIsZero(below) || above.sign == 1 || arbIsZero(above)) error("atanh of a number outside of (-1, 1)");
+            lnArg = globalError ? intToArb(1, accu) : arb_divide(above, below);
+        }
+        else {
+            if(opID == op_acosh && (x.sign == 1 || inner.sign == 1)) error("acosh of a number below 1");
+            Arb root = globalError ? intToArb(0, accu) : arb_sqrt(inner);
+            lnArg = arb_add(x, root);
+            freeArb(root);
+        }
+        out = arb_ln(lnArg);
+        if(opID == op_atanh) {
+            Arb half = arbDivInt(out, 2);
+            freeArb(out);
+            out = half;
+        }
+        //asinh(-x) = -asinh(x), which avoids the cancellation in x + sqrt(x^2 + 1)
+        if(opID == op_asinh && sign == 1 && !arbIsZero(out)) out.sign = 1;
+        freeArb(oneArb);
+        freeArb(square);
+        freeArb(inner);
+        freeArb(above);
+        freeArb(below);
+        freeArb(lnArg);
+    }
+    freeArb(x);
+    //Apply degree ratio
+    if(degrat != 1) {
+        Arb ratio = getArbDegrat(accu + 1);
+        Arb scaled = arb_divide(out, ratio);
+        freeArb(out);
+        freeArb(ratio);
+        out = scaled;
+        out.accu = accu;
+        trimZeroes(&out);
+    }
+    return out;
+}
+void applyArbTrig(Value* one, int type) {
+    ArbNum* num = one->numArb;
+    if(!arbIsReal(*num)) {
+        error("complex arbitrary-precision numbers are not supported");
+        return;
+    }
+    Arb out = arbTrig(type, num->r);
+    freeArb(num->r);
+    num->r = out;
+}
+//Applies func to one and two as complex numbers, op is the unit interaction
+Value valArbBinary(Value one, Value two, ArbNum func(ArbNum, ArbNum), char op) {
+    ArbNum a = getArbNum(one);
+    ArbNum b = getArbNum(two);
+    Value out = NULLVAL;
+    if(!globalError) {
+        unit_t unit = unitInteract(a.u, b.u, op, 0);
+        if(!globalError) {
+            ArbNum result = func(a, b);
+            if(!globalError) out = newValArbNum(result, unit);
+            else freeArbNum(result);
+        }
+    }
+    freeArbNum(a);
+    freeArbNum(b);
+    return out;
+}
+//Principal nth root of one for n = 2 or 3
+Value valArbRoot(Value one, int n) {
+    Arb base = getArbR(one);
+    if(globalError) {
+        freeArb(base);
+        return NULLVAL;
+    }
+    unit_t unit = one.type == value_arb ? one.numArb->u : one.u;
+    char sign = base.sign;
+    base.sign = 0;
+    Arb root = arb_root(base, n);
+    freeArb(base);
+    Value out = newValArb(root, unitInteract(unit, 0, '^', 1.0 / n));
+    //The principal root of a negative number is |one|^(1/n) * (cos(pi/n) + i*sin(pi/n))
+    if(sign == 1) {
+        ArbNum* num = out.numArb;
+        if(n == 2) {
+            num->i = root;
+            num->r = intToArb(0, root.accu);
+        }
+        else {
+            Arb half = arbPow2(-1, root.accu);
+            Arb three = intToArb(3, root.accu);
+            Arb sqrt3 = arb_sqrt(three);
+            Arb halfRoot = arb_mult(root, half);
+            num->r = halfRoot;
+            num->i = arb_mult(halfRoot, sqrt3);
+            freeArb(root);
+            freeArb(half);
+            freeArb(three);
+            freeArb(sqrt3);
+        }
+    }
+    return out;
+}
+Value valArbPower(Value one, Value two) {
+    ArbNum base = getArbNum(one);
+    ArbNum power = getArbNum(two);
+    Value out = NULLVAL;
+    //The square root of a real number has a faster path, which also covers negative numbers
+    Arb half = arbPow2(-1, power.r.accu);
+    bool isRoot = arbIsZero(power.i) && arbIsZero(base.i) && power.r.sign == 0 && arbCmp(power.r, half) == 0;
+    freeArb(half);
+    if(!globalError && isRoot) out = valArbRoot(one, 2);
+    else if(!globalError) {
+        unit_t unit = unitInteract(base.u, power.u, '^', arbToDouble(power.r));
+        if(!globalError) {
+            ArbNum result = arbNumPower(base, power);
+            if(!globalError) out = newValArbNum(result, unit);
+            else freeArbNum(result);
+        }
+    }
+    freeArbNum(base);
+    freeArbNum(power);
+    return out;
+}
+//Writes an integer argument of a number theory function to out, errors if it is not an exact integer
+bool getArbInteger(Value val, const char* name, Arb* out) {
+    int accu = globalAccuracy > 3 ? globalAccuracy : 3;
+    if(val.type == value_dec) {
+        Value arb = newValArb(decToArb(val.numArb->r, accu), val.numArb->u);
+        bool isInteger = getArbInteger(arb, name, out);
+        freeValue(arb);
+        return isInteger;
+    }
+    if(val.type == value_num) {
+        if(val.i != 0 || val.r != floor(val.r) || fabs(val.r) > 9007199254740992.0) {
+            error("%s requires integers, which must be below 2^53 outside of accurate mode", name);
+            return false;
+        }
+        *out = doubleToArb(val.r, accu);
+        return true;
+    }
+    Arb r = val.numArb->r;
+    if(r.mantissa == NULL) {
+        *out = intToArb(0, accu);
+        return true;
+    }
+    if(!arbIsReal(*val.numArb) || r.exp < r.len - 1) {
+        error("%s requires integers", name);
+        return false;
+    }
+    //Digits past the accuracy have been rounded off
+    if(r.exp >= r.accu) {
+        error("%s requires an accuracy that covers every digit of its arguments", name);
+        return false;
+    }
+    *out = copyArb(r);
+    return true;
+}
+//isprime, gcd and modpow, the result is arbitrary-precision if any argument is
+Value valNumberTheory(int op, const Value* args) {
+    const char* name = stdfunctions[op].name;
+    int argCount = op == op_isprime ? 1 : (op == op_gcd ? 2 : 3);
+    Arb ints[3];
+    bool isArb = false;
+    for(int i = 0;i < argCount;i++) {
+        if(args[i].type == value_arb) isArb = true;
+        if(!getArbInteger(args[i], name, ints + i)) {
+            for(int j = 0;j < i;j++) freeArb(ints[j]);
+            return NULLVAL;
+        }
+    }
+    Value out;
+    if(op == op_isprime) out = newValNum(arbIsPrime(ints[0]), 0, 0);
+    else {
+        Arb result = op == op_gcd ? arb_gcd(ints[0], ints[1]) : arb_modpow(ints[0], ints[1], ints[2]);
+        if(isArb) out = newValArb(result, 0);
+        else {
+            out = newValNum(arbToDouble(result), 0, 0);
+            freeArb(result);
+        }
+    }
+    for(int i = 0;i < argCount;i++) freeArb(ints[i]);
+    return out;
+}
+#pragma endregion
+#pragma region Arbitrary Precision Vectors
+/*
+    Members of an ArbVec are written in place with these, so vector operations only allocate
+    their result. Temporaries are in the arena, and dst may be the same as one or two.
+*/
+ArbNum arbNumScratch(int accu) {
+    ArbNum out;
+    out.r = arbScratchBuffer(accu);
+    out.i = arbScratchBuffer(accu);
+    out.u = 0;
+    return out;
+}
+void arbNumSetInto(ArbNum* dst, ArbNum src) {
+    arb_set_into(&dst->r, src.r);
+    arb_set_into(&dst->i, src.i);
+    dst->u = src.u;
+}
+void arbNumAddInto(ArbNum* dst, ArbNum one, ArbNum two) {
+    arb_add_into(&dst->r, one.r, two.r);
+    arb_add_into(&dst->i, one.i, two.i);
+}
+void arbNumSubtractInto(ArbNum* dst, ArbNum one, ArbNum two) {
+    arb_subtract_into(&dst->r, one.r, two.r);
+    arb_subtract_into(&dst->i, one.i, two.i);
+}
+void arbNumMultInto(ArbNum* dst, ArbNum one, ArbNum two) {
+    if(arbIsZero(one.i) && arbIsZero(two.i)) {
+        arb_mult_into(&dst->r, one.r, two.r);
+        arb_set_into(&dst->i, one.i);
+        return;
+    }
+    long long mark = arbArenaMark();
+    int accu = dst->r.accu + 1;
+    Arb ac = arbScratchBuffer(accu), bd = arbScratchBuffer(accu);
+    Arb ad = arbScratchBuffer(accu), bc = arbScratchBuffer(accu);
+    arb_mult_into(&ac, one.r, two.r);
+    arb_mult_into(&bd, one.i, two.i);
+    arb_mult_into(&ad, one.r, two.i);
+    arb_mult_into(&bc, one.i, two.r);
+    arb_subtract_into(&dst->r, ac, bd);
+    arb_add_into(&dst->i, ad, bc);
+    arbArenaRelease(mark);
+}
+//Returns the larger component of one, to compare magnitudes without a square root
+Arb arbNumLargest(ArbNum one) {
+    return arbCmp(one.r, one.i) >= 0 ? one.r : one.i;
+}
+//Returns a copy of vec at accu digits, with room for results to be written into its members
+Value arbVecWithAccu(ArbVec* vec, int accu) {
+    Value out = newValArbVec(vec->width, vec->height, accu);
+    for(int i = 0;i < vec->total;i++) arbNumSetInto(out.vecArb->val + i, vec->val[i]);
+    return out;
+}
+//Returns whether an operation on one and two has an arbitrary-precision vector result
+bool isArbVecOperation(Value one, Value two) {
+    if(one.type == value_arbvec || two.type == value_arbvec) return true;
+    return (one.type == value_vec || two.type == value_vec) && (one.type == value_arb || two.type == value_arb);
+}
+//Applies op elementwise, scalars are applied to every member
+Value valArbVecBinary(Value one, Value two, char op) {
+    int freeType = 0;
+    Value vecs[2] = { one, two };
+    ArbNum scalars[2];
+    bool isScalar[2];
+    for(int i = 0;i < 2;i++) {
+        isScalar[i] = vecs[i].type == value_num || vecs[i].type == value_arb;
+        if(isScalar[i]) scalars[i] = getArbNum(vecs[i]);
+        else if(vecs[i].type != value_arbvec) {
+            vecs[i] = arbVecFromValue(vecs[i]);
+            freeType |= 1 << i;
+        }
+    }
+    Value out = NULLVAL;
+    if(globalError) goto end;
+    //Dividing by a scalar is multiplying by its reciprocal
+    if(op == '/' && isScalar[1]) {
+        ArbNum unit = getArbNum(newValNum(1, 0, 0));
+        ArbNum recip = arbNumDivide(unit, scalars[1]);
+        recip.u = scalars[1].u;
+        freeArbNum(unit);
+        freeArbNum(scalars[1]);
+        scalars[1] = recip;
+    }
+    ArbVec* oneVec = isScalar[0] ? NULL : vecs[0].vecArb;
+    ArbVec* twoVec = isScalar[1] ? NULL : vecs[1].vecArb;
+    int width, height, accu;
+    if(oneVec == NULL || twoVec == NULL) {
+        ArbVec* vec = oneVec == NULL ? twoVec : oneVec;
+        width = vec->width;
+        height = vec->height;
+        accu = vec->accu;
+    }
+    else {
+        //Sums fill the missing members with zero, products only use the overlap
+        bool useMax = op == '+';
+        width = (oneVec->width < twoVec->width) ^ useMax ? oneVec->width : twoVec->width;
+        height = (oneVec->height < twoVec->height) ^ useMax ? oneVec->height : twoVec->height;
+        accu = oneVec->accu > twoVec->accu ? oneVec->accu : twoVec->accu;
+    }
+    out = newValArbVec(width, height, accu);
+    ArbNum zero = { 0 };
+    for(int x = 0;x < width;x++) for(int y = 0;y < height;y++) {
+        ArbNum a = zero, b = zero;
+        if(oneVec == NULL) a = scalars[0];
+        else if(x < oneVec->width && y < oneVec->height) a = oneVec->val[x + y * oneVec->width];
+        if(twoVec == NULL) b = scalars[1];
+        else if(x < twoVec->width && y < twoVec->height) b = twoVec->val[x + y * twoVec->width];
+        ArbNum* cell = out.vecArb->val + x + y * width;
+        unit_t unit = unitInteract(a.u, b.u, op, 0);
+        if(globalError) break;
+        if(op == '+') arbNumAddInto(cell, a, b);
+        else if(op == '*' || twoVec == NULL) arbNumMultInto(cell, a, b);
+        else {
+            ArbNum quotient = arbNumDivide(a, b);
+            arbNumSetInto(cell, quotient);
+            freeArbNum(quotient);
+        }
+        cell->u = unit;
+    }
+    if(globalError) {
+        freeValue(out);
+        out = NULLVAL;
+    }
+end:
+    for(int i = 0;i < 2;i++) {
+        if(isScalar[i]) freeArbNum(scalars[i]);
+        else if(freeType & (1 << i)) freeValue(vecs[i]);
+    }
+    return out;
+}
+/*
+    Linear algebra works on a copy with one extra digit, using Gaussian elimination with partial pivoting,
+    so an n by n matrix takes n^3 multiplications and n reciprocals instead of n! products.
+    Rows are swapped by swapping the members, which keep pointing into the same pool.
+*/
+//Returns the row at or below k with the largest member in column k, or -1 if they are all zero
+int arbPivotRow(ArbVec* vec, int k) {
+    int width = vec->width, best = k;
+    for(int j = k + 1;j < vec->height;j++) {
+        if(arbCmp(arbNumLargest(vec->val[k + j * width]), arbNumLargest(vec->val[k + best * width])) > 0) best = j;
+    }
+    ArbNum pivot = vec->val[k + best * width];
+    if(arbIsZero(pivot.r) && arbIsZero(pivot.i)) return -1;
+    return best;
+}
+void arbSwapRows(ArbVec* vec, int one, int two) {
+    for(int i = 0;i < vec->width;i++) {
+        ArbNum temp = vec->val[i + one * vec->width];
+        vec->val[i + one * vec->width] = vec->val[i + two * vec->width];
+        vec->val[i + two * vec->width] = temp;
+    }
+}
+ArbNum arbDeterminant(ArbVec* vec) {
+    int n = vec->width;
+    Value work = arbVecWithAccu(vec, vec->accu + 1);
+    ArbVec* m = work.vecArb;
+    long long mark = arbArenaMark();
+    ArbNum factor = arbNumScratch(m->accu), product = arbNumScratch(m->accu);
+    ArbNum det = arbNumScratch(m->accu);
+    ArbNum zero = { 0 };
+    det.r.mantissa[0] = 1;
+    bool negate = false;
+    for(int k = 0;k < n;k++) {
+        int pivotRow = arbPivotRow(m, k);
+        if(pivotRow == -1) {
+            arbNumSetInto(&det, zero);
+            break;
+        }
+        if(pivotRow != k) {
+            arbSwapRows(m, k, pivotRow);
+            negate = !negate;
+        }
+        ArbNum pivot = m->val[k + k * n];
+        arbNumMultInto(&det, det, pivot);
+        if(k == n - 1) break;
+        ArbNum unit = getArbNum(newValNum(1, 0, 0));
+        ArbNum recip = arbNumDivide(unit, pivot);
+        for(int j = k + 1;j < n;j++) {
+            ArbNum below = m->val[k + j * n];
+            if(arbIsZero(below.r) && arbIsZero(below.i)) continue;
+            arbNumMultInto(&factor, below, recip);
+            for(int i = k + 1;i < n;i++) {
+                arbNumMultInto(&product, factor, m->val[i + k * n]);
+                arbNumSubtractInto(m->val + i + j * n, m->val[i + j * n], product);
+            }
+        }
+        freeArbNum(unit);
+        freeArbNum(recip);
+    }
+    ArbNum out;
+    out.r = arbWithAccu(det.r, vec->accu);
+    out.i = arbWithAccu(det.i, vec->accu);
+    out.u = 0;
+    if(negate && !arbIsZero(out.r)) out.r.sign ^= 1;
+    if(negate && !arbIsZero(out.i)) out.i.sign ^= 1;
+    arbArenaRelease(mark);
+    freeValue(work);
+    return out;
+}
+Value arbTranspose(ArbVec* vec) {
+    Value out = newValArbVec(vec->height, vec->width, vec->accu);
+    for(int i = 0;i < vec->width;i++) for(int j = 0;j < vec->height;j++) {
+        arbNumSetInto(out.vecArb->val + j + i * vec->height, vec->val[i + j * vec->width]);
+    }
+    return out;
+}
+Value arbMatMult(ArbVec* one, ArbVec* two) {
+    int accu = one->accu > two->accu ? one->accu : two->accu;
+    Value out = newValArbVec(two->width, one->height, accu);
+    long long mark = arbArenaMark();
+    ArbNum cell = arbNumScratch(accu + 1), product = arbNumScratch(accu + 1);
+    ArbNum zero = { 0 };
+    for(int i = 0;i < two->width;i++) for(int j = 0;j < one->height;j++) {
+        arbNumSetInto(&cell, zero);
+        for(int x = 0;x < one->width;x++) {
+            arbNumMultInto(&product, one->val[x + j * one->width], two->val[i + x * two->width]);
+            arbNumAddInto(&cell, cell, product);
+        }
+        arbNumSetInto(out.vecArb->val + i + j * two->width, cell);
+    }
+    arbArenaRelease(mark);
+    return out;
+}
+//Gauss-Jordan elimination, applying the same row operations to the identity matrix
+Value arbMatInv(ArbVec* vec) {
+    int n = vec->width;
+    Value work = arbVecWithAccu(vec, vec->accu + 1);
+    Value inverse = newValArbVec(n, n, vec->accu + 1);
+    ArbVec* m = work.vecArb;
+    ArbVec* inv = inverse.vecArb;
+    for(int k = 0;k < n;k++) inv->val[k + k * n].r.mantissa[0] = 1;
+    long long mark = arbArenaMark();
+    ArbNum product = arbNumScratch(m->accu);
+    for(int k = 0;k < n;k++) {
+        int pivotRow = arbPivotRow(m, k);
+        if(pivotRow == -1) {
+            error("cannot take inverse of singular matrix");
+            break;
+        }
+        if(pivotRow != k) {
+            arbSwapRows(m, k, pivotRow);
+            arbSwapRows(inv, k, pivotRow);
+        }
+        ArbNum unit = getArbNum(newValNum(1, 0, 0));
+        ArbNum recip = arbNumDivide(unit, m->val[k + k * n]);
+        for(int i = k + 1;i < n;i++) arbNumMultInto(m->val + i + k * n, m->val[i + k * n], recip);
+        for(int i = 0;i < n;i++) arbNumMultInto(inv->val + i + k * n, inv->val[i + k * n], recip);
+        for(int j = 0;j < n;j++) {
+            ArbNum factor = m->val[k + j * n];
+            if(j == k || (arbIsZero(factor.r) && arbIsZero(factor.i))) continue;
+            for(int i = k + 1;i < n;i++) {
+                arbNumMultInto(&product, factor, m->val[i + k * n]);
+                arbNumSubtractInto(m->val + i + j * n, m->val[i + j * n], product);
+            }
+            for(int i = 0;i < n;i++) {
+                arbNumMultInto(&product, factor, inv->val[i + k * n]);
+                arbNumSubtractInto(inv->val + i + j * n, inv->val[i + j * n], product);
+            }
+        }
+        freeArbNum(unit);
+        freeArbNum(recip);
+    }
+    arbArenaRelease(mark);
+    Value out = globalError ? NULLVAL : arbVecWithAccu(inv, vec->accu);
+    freeValue(work);
+    freeValue(inverse);
+    return out;
+}
+#pragma endregion
+#pragma region Ball Arithmetic
+//Returns val as a ball that must be freed, numbers are exact and Arbs are within one unit in their last digit
+BallNum getBallNum(Value val) {
+    BallNum out;
+    if(val.type == value_ball) {
+        out = *val.numBall;
+        out.b = copyBall(out.b);
+        return out;
+    }
+    if(val.type == value_arb || val.type == value_num) {
+        ArbNum num = getArbNum(val);
+        if(!arbIsReal(num)) error("complex balls are not supported");
+        out.b = arbToBall(num.r, val.type == value_arb ? 1 : 0);
+        out.u = num.u;
+        freeArb(num.i);
+        return out;
+    }
+    error("Vectors are not supported in ball arithmetic");
+    out.b = arbToBall(intToArb(0, globalAccuracy), 0);
+    out.u = 0;
+    return out;
+}
+//Applies func to one and two as balls, op is the unit interaction
+Value valBallBinary(Value one, Value two, Ball func(Ball, Ball), char op) {
+    BallNum a = getBallNum(one);
+    BallNum b = getBallNum(two);
+    Value out = NULLVAL;
+    if(!globalError) {
+        unit_t unit = unitInteract(a.u, b.u, op, op == '^' ? arbToDouble(b.b.mid) : 0);
+        if(!globalError) {
+            Ball result = func(a.b, b.b);
+            if(!globalError) out = newValBall(result, unit);
+            else freeArb(result.mid);
+        }
+    }
+    freeArb(a.b.mid);
+    freeArb(b.b.mid);
+    return out;
+}
+void applyUnaryToBall(Value* one, Ball func(Ball)) {
+    Ball* b = &one->numBall->b;
+    Ball out = func(*b);
+    freeArb(b->mid);
+    *b = out;
+}
+//compTrig for a ball, only sin, cos, tan and atan are supported
+void applyBallTrig(Value* one, int type) {
+    Ball* b = &one->numBall->b;
+    Ball ratio = arbToBall(getArbDegrat(b->mid.accu + 1), 2);
+    Ball out;
+    if(type == op_atan) {
+        out = ball_atan(*b);
+        if(degrat != 1) {
+            Ball scaled = ball_divide(out, ratio);
+            freeArb(out.mid);
+            out = scaled;
+        }
+    }
+    else {
+        Ball x = degrat != 1 ? ball_mult(*b, ratio) : copyBall(*b);
+        if(type == op_sin) out = ball_sin(x);
+        else if(type == op_cos) out = ball_cos(x);
+        else out = ball_tan(x);
+        freeArb(x.mid);
+    }
+    freeArb(ratio.mid);
+    freeArb(b->mid);
+    *b = out;
+}
+#pragma endregion
+#pragma region Double-Double Values
+Value ddValueToArb(Value val) {
+    return newValArb(ddToArb(val.dd, globalAccuracy), val.u);
+}
+//Converts the double-doubles in one and two to Arbs and returns fallback(one,two)
+Value valDDFallback(Value one, Value two, Value fallback(Value, Value)) {
+    Value a = one.type == value_dd ? ddValueToArb(one) : one;
+    Value b = two.type == value_dd ? ddValueToArb(two) : two;
+    Value out = fallback(a, b);
+    if(one.type == value_dd) freeValue(a);
+    if(two.type == value_dd) freeValue(b);
+    return out;
+}
+//Applies func to one and two as double-doubles, op is the unit interaction
+//Anything other than real numbers and double-doubles is passed on to fallback as an Arb
+Value valDDBinary(Value one, Value two, DD func(DD, DD), char op, Value fallback(Value, Value)) {
+    bool realOne = one.type == value_dd || (one.type == value_num && one.i == 0);
+    bool realTwo = two.type == value_dd || (two.type == value_num && two.i == 0);
+    if(!realOne || !realTwo) return valDDFallback(one, two, fallback);
+    DD a = one.type == value_dd ? one.dd : newDD(one.r, 0);
+    DD b = two.type == value_dd ? two.dd : newDD(two.r, 0);
+    unit_t unit = unitInteract(one.u, two.u, op, op == '^' ? b.hi : 0);
+    if(globalError) return NULLVAL;
+    return newValDD(func(a, b), unit);
+}
+void applyUnaryToDD(Value* one, DD func(DD)) {
+    one->dd = func(one->dd);
+}
+//compTrig for a double-double, only sin, cos, tan and atan are supported
+void applyDDTrig(Value* one, int type) {
+    DD ratio = newDD(degrat, 0);
+    if(degrat == M_PI / 180 || degrat == M_PI / 200) ratio = ddDivide(newDD(ddPi[0], ddPi[1]), newDD(degrat == M_PI / 180 ? 180 : 200, 0));
+    DD x = one->dd;
+    if(type == op_atan) {
+        x = ddAtan(x);
+        if(degrat != 1) x = ddDivide(x, ratio);
+        one->dd = x;
+        return;
+    }
+    if(degrat != 1) x = ddMult(x, ratio);
+    //Larger arguments need more digits of pi than ddSinCos has
+    if(fabs(x.hi) >= 1048576) {
+        *one = ddValueToArb(*one);
+        applyArbTrig(one, type);
+        return;
+    }
+    if(type == op_sin) one->dd = ddSin(x);
+    else if(type == op_cos) one->dd = ddCos(x);
+    else one->dd = ddTan(x);
+}
+#pragma endregion
+#pragma region Decimal Values
+Value decValueToArb(Value val) {
+    return newValArb(decToArb(val.numArb->r, globalAccuracy), val.numArb->u);
+}
+//Applies func to one and two if both are decimal, op is the unit interaction
+//Anything else is converted to an Arb and passed on to fallback
+Value valDecBinary(Value one, Value two, Arb func(Arb, Arb), char op, Value fallback(Value, Value)) {
+    if(one.type != value_dec || two.type != value_dec) {
+        Value a = one.type == value_dec ? decValueToArb(one) : one;
+        Value b = two.type == value_dec ? decValueToArb(two) : two;
+        Value out = fallback(a, b);
+        if(one.type == value_dec) freeValue(a);
+        if(two.type == value_dec) freeValue(b);
+        return out;
+    }
+    unit_t unit = unitInteract(one.numArb->u, two.numArb->u, op, 0);
+    if(globalError) return NULLVAL;
+    return newValDec(func(one.numArb->r, two.numArb->r), unit);
+}
+#pragma endregion
 #pragma region Values
 Value valMult(Value one, Value two) {
+    if(one.type == value_dec || two.type == value_dec) return valDecBinary(one, two, &dec_mult, '*', &valMult);
+    if(one.type == value_ball || two.type == value_ball) return valBallBinary(one, two, &ball_mult, '*');
+    if(one.type == value_dd || two.type == value_dd) return valDDBinary(one, two, &ddMult, '*', &valMult);
+    if(isArbVecOperation(one, two)) return valArbVecBinary(one, two, '*');
+    if(one.type == value_arb || two.type == value_arb) return valArbBinary(one, two, &arbNumMult, '*');
     return applyBinaryToVector(one, two, &compMultiply, false, false);
 }
 Value valAdd(Value one, Value two) {
@@ -426,6 +1519,11 @@ Value valAdd(Value one, Value two) {
         if(freeType & 2) freeValue(two);
         return out;
     }
+    if(one.type == value_dec || two.type == value_dec) return valDecBinary(one, two, &dec_add, '+', &valAdd);
+    if(one.type == value_ball || two.type == value_ball) return valBallBinary(one, two, &ball_add, '+');
+    if(one.type == value_dd || two.type == value_dd) return valDDBinary(one, two, &ddAdd, '+', &valAdd);
+    if(isArbVecOperation(one, two)) return valArbVecBinary(one, two, '+');
+    if(one.type == value_arb || two.type == value_arb) return valArbBinary(one, two, &arbNumAdd, '+');
     return applyBinaryToVector(one, two, &compAdd, true, true);
 }
 Value valNegate(Value one) {
@@ -449,6 +1547,27 @@ Value valNegate(Value one) {
         }
         return out;
     }
+    if(one.type == value_arb || one.type == value_dec) {
+        Value out = copyValue(one);
+        if(!arbIsZero(out.numArb->r)) out.numArb->r.sign ^= 1;
+        if(!arbIsZero(out.numArb->i)) out.numArb->i.sign ^= 1;
+        return out;
+    }
+    if(one.type == value_arbvec) {
+        Value out = copyValue(one);
+        for(int i = 0;i < out.vecArb->total;i++) {
+            ArbNum* num = out.vecArb->val + i;
+            if(!arbIsZero(num->r)) num->r.sign ^= 1;
+            if(!arbIsZero(num->i)) num->i.sign ^= 1;
+        }
+        return out;
+    }
+    if(one.type == value_ball) {
+        Value out = copyValue(one);
+        if(!arbIsZero(out.numBall->b.mid)) out.numBall->b.mid.sign ^= 1;
+        return out;
+    }
+    if(one.type == value_dd) return newValDD(ddNegate(one.dd), one.u);
     if(one.type == value_func) {
         error("cannot negate functions");
         return NULLVAL;
@@ -456,9 +1575,21 @@ Value valNegate(Value one) {
     return NULLVAL;
 }
 Value valDivide(Value one, Value two) {
+    if(one.type == value_ball || two.type == value_ball) return valBallBinary(one, two, &ball_divide, '/');
+    if(one.type == value_dd || two.type == value_dd) return valDDBinary(one, two, &ddDivide, '/', &valDivide);
+    if(isArbVecOperation(one, two)) return valArbVecBinary(one, two, '/');
+    if(one.type == value_arb || two.type == value_arb) return valArbBinary(one, two, &arbNumDivide, '/');
     return applyBinaryToVector(one, two, &compDivide, false, false);
 }
 Value valPower(Value one, Value two) {
+    if(one.type == value_ball || two.type == value_ball) return valBallBinary(one, two, &ball_pow, '^');
+    if(one.type == value_dd || two.type == value_dd) {
+        //Negative bases with fractional powers are complex, which Arbs support
+        double power = getR(two);
+        if(getR(one) < 0 && power != floor(power)) return valDDFallback(one, two, &valPower);
+        return valDDBinary(one, two, &ddPower, '^', &valPower);
+    }
+    if(one.type == value_arb || two.type == value_arb) return valArbPower(one, two);
     return applyBinaryToVector(one, two, &compPower, true, false);
 }
 Value valModulo(Value one, Value two) {
@@ -477,6 +1608,12 @@ Value valAbs(Value one) {
         }
         return newValNum(sqrt(out), 0, 0);
     }
+    if(one.type == value_ball) {
+        Value out = copyValue(one);
+        out.numBall->b.mid.sign = 0;
+        return out;
+    }
+    if(one.type == value_dd) return newValDD(one.dd.hi < 0 ? ddNegate(one.dd) : one.dd, one.u);
     if(one.type == value_func) {
         error("cannot abs functions");
         return NULLVAL;
@@ -604,710 +1741,987 @@ Value computeTreeMicro(Tree tree, const Value* arguments, int argLen, Value* loc
 Value computeTree(Tree tree, const Value* args, int argLen, Value* localVars) {
     int isFree = 0;
     Value out = computeTreeMicro(tree, args, argLen, localVars, &isFree);
+    //Arb temporaries only live inside a single operation
+    arbArenaReset();
     if(!isFree) return copyValue(out);
     return out;
 }
-Value computeTreeMicro(Tree tree, const Value* arguments, int argLen, Value* localVars, int* isFree) {
-    if(tree.optype == optype_builtin) {
-        if(tree.op == op_val) return tree.value;
+#pragma region Builtin Functions
+/*
+    Builtins are computed by their handler in builtinHandlers, which is indexed by the op id.
+    The handlers get the computed and type checked arguments, which are freed by computeTreeMicro if needsFree is set.
+    A handler that returns a value it allocated sets isFree.
+*/
+#define BUILTIN(name) Value name(Tree tree, Value* args, int* needsFree, int* isFree, const Value* arguments, int argLen, Value* localVars)
 #define setOutToArgs(id) if(needsFree[id]){out=args[id];needsFree[id]=0;}else out=copyValue(args[id]);*isFree=1;args[id]=NULLVAL
-        //Vector Functions
-        Value out = NULLVAL;
-        int needsFree[tree.argCount];
-        memset(needsFree, 0, sizeof(needsFree));
-        //Compute each branch
-        Value args[tree.argCount];
-        memset(args, 0, sizeof(args));
-        const unsigned char* acceptableArgs = stdfunctions[tree.op].inputs;
-        for(int i = 0;i < tree.argCount;i++) {
-            const char* type[] = { "number","vector","anonymous function","arbitrary-precision number","string" };
-            args[i] = computeTreeMicro(tree.branch[i], arguments, argLen, localVars, needsFree + i);
-            if(globalError) goto ret;
-            if(args[i].type<0 || args[i].type>value_string) {
-                error("Invalid error value in call to %s", stdfunctions[tree.op].name);
-                goto ret;
-            }
-            if((acceptableArgs[i] & (2 << args[i].type)) == 0) {
-                if(tree.op == op_run && i != 0) continue;
-                if(tree.op == op_vector) continue;
-                error("Invalid %s in call to %s", type[args[i].type], stdfunctions[tree.op].name);
-                goto ret;
-            }
+//Basic operators
+BUILTIN(builtinI) {
+    return newValNum(0, 1, 0);
+}
+BUILTIN(builtinNeg) {
+    *isFree = 1;
+    return valNegate(args[0]);
+}
+BUILTIN(builtinPow) {
+    *isFree = 1;
+    return valPower(args[0], args[1]);
+}
+BUILTIN(builtinMod) {
+    *isFree = 1;
+    return valModulo(args[0], args[1]);
+}
+BUILTIN(builtinDiv) {
+    *isFree = 1;
+    return valDivide(args[0], args[1]);
+}
+BUILTIN(builtinMult) {
+    *isFree = 1;
+    return valMult(args[0], args[1]);
+}
+BUILTIN(builtinAdd) {
+    *isFree = 1;
+    return valAdd(args[0], args[1]);
+}
+BUILTIN(builtinSub) {
+    Value negative = valNegate(args[1]);
+    Value out = valAdd(args[0], negative);
+    freeValue(negative);
+    *isFree = 1;
+    return out;
+}
+//Trigonometric functions
+BUILTIN(builtinTrig) {
+    Value out;
+    setOutToArgs(0);
+    if(out.type == value_num) {
+        out.num = compTrig(tree.op, out.num);
+    }
+    else if(out.type == value_arb) applyArbTrig(&out, tree.op);
+    else if(out.type == value_ball) applyBallTrig(&out, tree.op);
+    else if(out.type == value_dd) applyDDTrig(&out, tree.op);
+    else if(out.type == value_vec) {
+        for(int i = 0;i < out.vec.total;i++)
+            out.vec.val[i] = compTrig(tree.op, out.vec.val[i]);
+    }
+    return out;
+}
+//Log, arg, and abs
+BUILTIN(builtinSqrt) {
+    *isFree = 1;
+    return valPower(args[0], newValNum(1.0 / 2, 0, 0));
+}
+BUILTIN(builtinCbrt) {
+    *isFree = 1;
+    if(args[0].type == value_arb) return valArbRoot(args[0], 3);
+    return valPower(args[0], newValNum(1.0 / 3, 0, 0));
+}
+BUILTIN(builtinExp) {
+    Value out;
+    setOutToArgs(0);
+    if(out.type == value_dd) applyUnaryToDD(&out, &ddExp);
+    else if(out.type == value_ball) applyUnaryToBall(&out, &ball_exp);
+    else if(out.type == value_arb) applyUnaryToArb(&out, &arb_exp);
+    else applyUnaryToVector(&out, &compExp);
+    return out;
+}
+BUILTIN(builtinLn) {
+    Value out;
+    setOutToArgs(0);
+    //Logarithms of negative numbers are complex, which Arbs support
+    if(out.type == value_dd && out.dd.hi <= 0) out = ddValueToArb(out);
+    if(out.type == value_dd) applyUnaryToDD(&out, &ddLn);
+    else if(out.type == value_ball) applyUnaryToBall(&out, &ball_ln);
+    else if(out.type == value_arb) applyArbLn(&out);
+    else applyUnaryToVector(&out, &compLn);
+    return out;
+}
+BUILTIN(builtinLogTen) {
+    Value out;
+    setOutToArgs(0);
+    if(out.type == value_arb) {
+        applyArbLogTen(&out);
+        return out;
+    }
+    applyUnaryToVector(&out, &compLn);
+    Value ln = out;
+    out = valMult(ln, newValNum(1 / log(10), 0, 0));
+    freeValue(ln);
+    return out;
+}
+BUILTIN(builtinLog) {
+    Value out;
+    setOutToArgs(0);
+    Value LnArg = out;
+    applyUnaryToVector(&LnArg, &compLn);
+    setOutToArgs(1);
+    Value LnBase = out;
+    applyUnaryToVector(&LnBase, &compLn);
+    out = valDivide(LnArg, LnBase);
+    freeValue(LnArg);
+    freeValue(LnBase);
+    return out;
+}
+BUILTIN(builtinNumberTheory) {
+    *isFree = 1;
+    return valNumberTheory(tree.op, args);
+}
+BUILTIN(builtinFact) {
+    Value out = NULLVAL;
+    if(args[0].type == value_num) {
+        args[0].r += 1;
+        out.num = compGamma(args[0].num);
+    }
+    if(args[0].type == value_arb) {
+        setOutToArgs(0);
+        applyUnaryToArb(&out, &arb_fact);
+    }
+    if(args[0].type == value_vec) {
+        setOutToArgs(0);
+        for(int i = 0;i < out.vec.total;i++) {
+            out.vec.val[i].r += 1;
+            out.vec.val[i] = compGamma(out.vec.val[i]);
         }
-        //Basic operators
-        if(tree.op < 9) {
-            if(tree.op == op_i) out = newValNum(0, 1, 0);
-            else if(tree.op == op_neg) out = valNegate(args[0]);
-            else if(tree.op == op_pow) out = valPower(args[0], args[1]);
-            else if(tree.op == op_mod) out = valModulo(args[0], args[1]);
-            else if(tree.op == op_div) out = valDivide(args[0], args[1]);
-            else if(tree.op == op_mult) out = valMult(args[0], args[1]);
-            else if(tree.op == op_add) out = valAdd(args[0], args[1]);
-            else if(tree.op == op_sub) {
-                Value negative = valNegate(args[1]);
-                out = valAdd(args[0], negative);
-                freeValue(negative);
-            }
-            *isFree = 1;
-            goto ret;
-        }
-        //Trigonometric functions
-        if(tree.op < 30) {
-            setOutToArgs(0);
-            if(out.type == value_num) {
-                out.num = compTrig(tree.op, out.num);
-            }
-            else if(out.type == value_vec) {
-                for(int i = 0;i < out.vec.total;i++)
-                    out.vec.val[i] = compTrig(tree.op, out.vec.val[i]);
-            }
-            goto ret;
+    }
+    return out;
+}
+BUILTIN(builtinSgn) {
+    Value abs = valAbs(args[0]);
+    Value out = valDivide(args[0], abs);
+    freeValue(abs);
+    *isFree = 1;
+    return out;
+}
+BUILTIN(builtinAbs) {
+    return valAbs(args[0]);
+}
+BUILTIN(builtinArg) {
+    Value out = NULLVAL;
+    if(args[0].type == value_num) {
+        out.r = atan2(args[0].i, args[0].r);
+        //The builtin atan2 is wrong for this edge case
+        if(args[0].i == 0 && args[0].r < 0) out.r = M_PI;
+        out.i = 0;
+        out.u = args[0].u;
+    }
+    if(args[0].type == value_vec) {
+        setOutToArgs(0);
+        for(int i = 0;i < out.vec.total;i++) {
+            Number num = out.vec.val[i];
+            out.vec.val[i].r = atan2(num.i, num.r);
+            //The builtin atan2 is wrong for this edge case
+            if(num.i == 0 && num.r < 0) out.vec.val[i].r = M_PI;
+            out.vec.val[i].i = 0;
+            out.vec.val[i].u = num.u;
         }
-        //Log, arg, and abs
-        if(tree.op < 46) {
-            if(tree.op == op_sqrt) {
-                out = valPower(args[0], newValNum(1.0 / 2, 0, 0));
-                *isFree = 1;
-            }
-            if(tree.op == op_cbrt) {
-                out = valPower(args[0], newValNum(1.0 / 3, 0, 0));
-                *isFree = 1;
-            }
-            if(tree.op == op_exp) {
-                setOutToArgs(0);
-                applyUnaryToVector(&out, &compExp);
-            }
-            if(tree.op == op_ln) {
-                setOutToArgs(0);
-                applyUnaryToVector(&out, &compLn);
-            }
-            if(tree.op == op_logten) {
-                setOutToArgs(0);
-                applyUnaryToVector(&out, &compLn);
-                Value ln = out;
-                out = valMult(ln, newValNum(1 / log(10), 0, 0));
-                freeValue(ln);
-                *isFree = 1;
-            }
-            if(tree.op == op_log) {
-                setOutToArgs(0);
-                Value LnArg = out;
-                applyUnaryToVector(&LnArg, &compLn);
-                setOutToArgs(1);
-                Value LnBase = out;
-                applyUnaryToVector(&LnBase, &compLn);
-                out = valDivide(LnArg, LnBase);
-                freeValue(LnArg);
-                freeValue(LnBase);
-                *isFree = 1;
-            }
-            if(tree.op == op_fact) {
-                if(args[0].type == value_num) {
-                    args[0].r += 1;
-                    out.num = compGamma(args[0].num);
-                }
-                if(args[0].type == value_vec) {
-                    setOutToArgs(0);
-                    for(int i = 0;i < out.vec.total;i++) {
-                        out.vec.val[i].r += 1;
-                        out.vec.val[i] = compGamma(out.vec.val[i]);
-                    }
-                }
-            }
-            if(tree.op == op_sgn) {
-                Value abs = valAbs(args[0]);
-                out = valDivide(args[0], abs);
-                freeValue(abs);
-                *isFree = 1;
-            }
-            if(tree.op == op_abs) out = valAbs(args[0]);
-            if(tree.op == op_arg) {
-                if(args[0].type == value_num) {
-                    out.r = atan2(args[0].i, args[0].r);
-                    //The builtin atan2 is wrong for this edge case
-                    if(args[0].i == 0 && args[0].r < 0) out.r = M_PI;
-                    out.i = 0;
-                    out.u = args[0].u;
-                }
-                if(args[0].type == value_vec) {
-                    setOutToArgs(0);
-                    for(int i = 0;i < out.vec.total;i++) {
-                        Number num = out.vec.val[i];
-                        out.vec.val[i].r = atan2(num.i, num.r);
-                        //The builtin atan2 is wrong for this edge case
-                        if(num.i == 0 && num.r < 0) out.vec.val[i].r = M_PI;
-                        out.vec.val[i].i = 0;
-                        out.vec.val[i].u = num.u;
-                    }
-                }
-            }
-            goto ret;
-        }
-        //Rounding and conditionals
-        if(tree.op < 63) {
-            if(tree.op >= op_round && tree.op <= op_ceil) {
-                double (*roundType)(double);
-                if(tree.op == op_round) roundType = &round;
-                if(tree.op == op_floor) roundType = &floor;
-                if(tree.op == op_ceil) roundType = &ceil;
-                setOutToArgs(0);
-                if(out.type == value_num) {
-                    out.r = (*roundType)(out.r);
-                    out.i = (*roundType)(out.i);
-                }
-                if(out.type == value_vec) {
-                    for(int i = 0;i < out.vec.total;i++) {
-                        out.vec.val[i].r = (*roundType)(out.vec.val[i].r);
-                        out.vec.val[i].i = (*roundType)(out.vec.val[i].i);
-                    }
-                }
-                goto ret;
-            }
-            if(tree.op == op_getr) {
-                if(args[0].type == value_num) out.r = args[0].r;
-                if(args[0].type == value_vec) {
-                    setOutToArgs(0);
-                    for(int i = 0;i < out.vec.total;i++) {
-                        out.vec.val[i].i = 0;
-                        out.vec.val[i].u = 0;
-                    }
-                }
-                goto ret;
-            }
-            if(tree.op == op_geti) {
-                if(args[0].type == value_num) out.r = args[0].i;
-                if(args[0].type == value_vec) {
-                    setOutToArgs(0);
-                    for(int i = 0;i < out.vec.total;i++) {
-                        out.vec.val[i].r = out.vec.val[i].i;
-                        out.vec.val[i].i = 0;
-                        out.vec.val[i].u = 0;
-                    }
-                }
-                goto ret;
-            }
-            if(tree.op == op_getu) {
-                if(args[0].type == value_num) {
-                    out.r = 1;
-                    out.u = args[0].u;
-                }
-                if(args[0].type == value_vec) {
-                    setOutToArgs(0);
-                    for(int i = 0;i < out.vec.total;i++) {
-                        out.vec.val[i].r = 1;
-                        out.vec.val[i].i = 0;
-                    }
-                }
-                goto ret;
-            }
-            //Comparisons
-            if(tree.op < 59) {
-                int cmp = valCompare(args[0], args[1]);
-                //Equal
-                if(cmp == 0 && (tree.op == op_equal || tree.op == op_lt_equal || tree.op == op_gt_equal)) out.r = 1;
-                //Not equal
-                if(cmp != 0 && tree.op == op_not_equal) out.r = 1;
-                //Greater than
-                if(cmp == 1 && (tree.op == op_gt || tree.op == op_gt_equal)) out.r = 1;
-                //Less than
-                if(cmp == -1 && (tree.op == op_lt || tree.op == op_lt_equal)) out.r = 1;
-                goto ret;
-            }
-            if(args[0].type != args[1].type) {
-                int frees = convertToSameType(needsFree[0] + 2 * needsFree[1], args, args + 1);
-                needsFree[0] = frees & 1;
-                needsFree[1] = frees & 2;
-            }
-            if(tree.op == op_min || tree.op == op_max) {
-                if(args[0].type == value_num) {
-                    bool isGreater = args[0].r > args[1].r;
-                    bool expectsGreater = tree.op == op_max;
-                    if(isGreater ^ expectsGreater) out = args[1];
-                    else out = args[0];
-                }
-                if(args[0].type == value_vec) {
-                    Vector one = args[0].vec;
-                    Vector two = args[1].vec;
-                    int width = one.width > two.width ? one.width : two.width;
-                    int height = one.height > two.height ? one.height : two.height;
-                    out.type = value_vec;
-                    out.vec = newVec(width, height);
-                    *isFree = 1;
-                    for(int i = 0;i < width;i++) for(int j = 0;j < height;j++) {
-                        Number oneNum = NULLNUM;
-                        Number twoNum = NULLNUM;
-                        if(i < one.width && j < one.height) oneNum = one.val[i + j * one.width];
-                        if(i < two.width && j < two.height) twoNum = two.val[i + j * two.width];
-                        if((oneNum.r > twoNum.r) ^ (tree.op == op_max)) out.vec.val[i + j * width] = twoNum;
-                        else out.vec.val[i + j * width] = oneNum;
-                    }
-                }
-            }
-            if(tree.op == op_lerp) {
-                //(1 - c) * one + c * two;
-                Value c = computeTree(tree.branch[2], args, argLen, localVars);
-                Value negativeC = valNegate(c);
-                Value oneSubC = valAdd(newValNum(1, 0, 0), negativeC);
-                Value cTimesTwo = valMult(c, args[1]);
-                Value oneSubCTimesTwo = valMult(oneSubC, args[0]);
-                out = valAdd(cTimesTwo, oneSubCTimesTwo);
-                *isFree = 1;
-                freeValue(c);
-                freeValue(negativeC);
-                freeValue(oneSubC);
-                freeValue(cTimesTwo);
-                freeValue(oneSubCTimesTwo);
-            }
-            if(tree.op == op_dist) {
-                if(args[0].type == value_num) out = newValNum(sqrt(pow(fabs(args[0].r - args[1].r), 2) + pow(fabs(args[0].i - args[1].i), 2)), 0, 0);
-                if(args[0].type == value_vec) {
-                    Vector one = args[0].vec;
-                    Vector two = args[1].vec;
-                    int width = one.width > two.width ? one.width : two.width;
-                    int height = one.height > two.height ? one.height : two.height;
-                    for(int i = 0;i < width;i++) for(int j = 0;j < height;j++) {
-                        Number oneNum, twoNum;
-                        if(i < one.width && j < one.height) oneNum = one.val[i + j * one.width];
-                        else oneNum = NULLNUM;
-                        if(i < two.width && j < two.height) twoNum = two.val[i + j * two.width];
-                        else twoNum = NULLNUM;
-                        out.r += pow(oneNum.r - twoNum.r, 2) + pow(oneNum.i - twoNum.i, 2);
-                    }
-                    out.r = sqrt(out.r);
-                }
-            }
-            goto ret;
-        }
-        //Binary Operations
-        if(tree.op < 72) {
-            if(tree.op == op_not) {
-                if(args[0].type == value_num) out.num = compBinNot(args[0].num);
-                if(args[0].type == value_vec) {
-                    setOutToArgs(0);
-                    for(int i = 0;i < out.vec.total;i++) out.vec.val[i] = compBinNot(out.vec.val[i]);
-                }
-                goto ret;
-            }
-            //Apply the binary operations properly with vectors
-            const Number(*funcs[])(Number, Number) = { &compBinAnd,&compBinOr,&compBinXor,&compBinLs,&compBinRs };
-            const bool useMax[] = { false,true,true,true,true };
-            int op = tree.op - op_and;
-            out = applyBinaryToVector(args[0], args[1], funcs[op], useMax[op], false);
-            *isFree = 1;
-            goto ret;
-        }
-        //Constants
-        if(tree.op < 88) {
-            if(tree.op == op_pi) out = newValNum(3.1415926535897932, 0, 0);
-            else if(tree.op == op_e) out = newValNum(2.718281828459045, 0, 0);
-            else if(tree.op == op_phi) out = newValNum(1.618033988749894, 0, 0);
-            else if(tree.op == op_typeof) out.r = args[0].type;
-            else if(tree.op == op_ans) {
-                if(historyCount == 0) {
-                    error("no previous answer", NULL);
-                    goto ret;
-                }
-                out = history[historyCount - 1];
-            }
-            else if(tree.op == op_hist) {
-                int i = (int)floor(getR(args[0]));
-                if(i < 0) {
-                    if(i < -historyCount) {
-                        error("history too short", NULL);
-                        goto ret;
-                    }
-                    out = history[historyCount + i];
-                    goto ret;
-                }
-                if(i >= historyCount) {
-                    error("history too short", NULL);
-                    goto ret;
-                }
-                out = history[i];
-            }
-            else if(tree.op == op_histnum) out = newValNum(historyCount, 0, 0);
-            else if(tree.op == op_rand) out = newValNum((double)rand() / RAND_MAX, 0, 0);
-            goto ret;
-        }
-        //Run, Sum, and Product
-        if(tree.op < 93) {
-            if(tree.op == op_run) {
-                if(args[0].type == value_string) {
-                    char name[strlen(args[0].string) + 1];
-                    strcpy(name, args[0].string);
-                    lowerCase(name);
-                    Tree op = findFunction(name, false, NULL, NULL);
-                    if(op.optype == optype_builtin) {
-                        //TODO: this unecessarily recomputes args[1], args[2]...
-                        Tree toCompute = NULLOPERATION;
-                        toCompute.op = op.op;
-                        toCompute.argCount = tree.argCount - 1;
-                        toCompute.branch = tree.branch + 1;
-                        out = computeTree(toCompute, arguments, argLen, localVars);
-                    }
-                    else if(op.optype == optype_custom) {
-                        if(customfunctions[op.op].argCount > tree.argCount - 1) error("not enough args in run function");
-                        else out = runFunction(customfunctions[op.op], args + 1);
-                    }
-                    else error("function '%s' not found", args[0].string);
-                    *isFree = 1;
-                    goto ret;
-                }
-                int argCount = tree.argCount - 1;
-                int requiredArgs = argListLen(args[0].argNames);
-                if(argCount < requiredArgs) {
-                    error("not enough args in run function");
-                    goto ret;
-                }
-                out = runAnonymousFunction(args[0], args + 1);
-                *isFree = 1;
-                goto ret;
-            }
-            int argCount = argListLen(args[0].argNames);
-            if(argCount < 2) argCount = 2;
-            Value tempArgs[argCount];
-            memset(tempArgs, 0, sizeof(tempArgs));
-            double loopArgs[3];
-            loopArgs[0] = getR(args[1]);
-            loopArgs[1] = getR(args[2]);
-            if(tree.argCount > 3) loopArgs[2] = getR(args[3]);
-            else loopArgs[2] = 1;
-            double i;
-            int loopCount = 0;
-            if(tree.op == op_sum) {
-                out = newValNum(0, 0, 0);
-                tempArgs[0] = newValNum(0, 0, 0);
-                for(i = loopArgs[0];i <= loopArgs[1];i += loopArgs[2]) {
-                    tempArgs[0].r = i;
-                    tempArgs[1].r = loopCount;
-                    Value current = runAnonymousFunction(args[0], tempArgs);
-                    Value new;
-                    if(current.type == value_string && i == loopArgs[0])  new = current;
-                    else {
-                        new = valAdd(out, current);
-                        freeValue(out);
-                        freeValue(current);
-                    }
-                    if(globalError) { freeValue(new);goto ret; }
-                    out = new;
-                    loopCount++;
-                    if(loopCount > 100000) { error("infinite loop detected");goto ret; }
-                }
-            }
-            if(tree.op == op_product) {
-                out = newValNum(1, 0, 0);
-                tempArgs[0] = newValNum(0, 0, 0);
-                for(i = loopArgs[0]; i <= loopArgs[1];i += loopArgs[2]) {
-                    tempArgs[0].r = i;
-                    tempArgs[1].r = loopCount;
-                    Value current = runAnonymousFunction(args[0], tempArgs);
-                    Value new = valMult(out, current);
-                    freeValue(out);
-                    freeValue(current);
-                    if(globalError) { freeValue(new);goto ret; }
-                    out = new;
-                    loopCount++;
-                    if(loopCount > 100000) { error("infinite loop detected");goto ret; }
-                }
+    }
+    return out;
+}
+//Rounding and conditionals
+BUILTIN(builtinRound) {
+    Value out;
+    double (*roundType)(double) = &round;
+    if(tree.op == op_floor) roundType = &floor;
+    if(tree.op == op_ceil) roundType = &ceil;
+    setOutToArgs(0);
+    if(out.type == value_num) {
+        out.r = (*roundType)(out.r);
+        out.i = (*roundType)(out.i);
+    }
+    if(out.type == value_vec) {
+        for(int i = 0;i < out.vec.total;i++) {
+            out.vec.val[i].r = (*roundType)(out.vec.val[i].r);
+            out.vec.val[i].i = (*roundType)(out.vec.val[i].i);
+        }
+    }
+    return out;
+}
+BUILTIN(builtinGetR) {
+    Value out = NULLVAL;
+    if(args[0].type == value_num) out.r = args[0].r;
+    if(args[0].type == value_vec) {
+        setOutToArgs(0);
+        for(int i = 0;i < out.vec.total;i++) {
+            out.vec.val[i].i = 0;
+            out.vec.val[i].u = 0;
+        }
+    }
+    return out;
+}
+BUILTIN(builtinGetI) {
+    Value out = NULLVAL;
+    if(args[0].type == value_num) out.r = args[0].i;
+    if(args[0].type == value_vec) {
+        setOutToArgs(0);
+        for(int i = 0;i < out.vec.total;i++) {
+            out.vec.val[i].r = out.vec.val[i].i;
+            out.vec.val[i].i = 0;
+            out.vec.val[i].u = 0;
+        }
+    }
+    return out;
+}
+BUILTIN(builtinGetU) {
+    Value out = NULLVAL;
+    if(args[0].type == value_num) {
+        out.r = 1;
+        out.u = args[0].u;
+    }
+    if(args[0].type == value_vec) {
+        setOutToArgs(0);
+        for(int i = 0;i < out.vec.total;i++) {
+            out.vec.val[i].r = 1;
+            out.vec.val[i].i = 0;
+        }
+    }
+    return out;
+}
+BUILTIN(builtinCompare) {
+    Value out = NULLVAL;
+    int cmp = valCompare(args[0], args[1]);
+    //Equal
+    if(cmp == 0 && (tree.op == op_equal || tree.op == op_lt_equal || tree.op == op_gt_equal)) out.r = 1;
+    //Not equal
+    if(cmp != 0 && tree.op == op_not_equal) out.r = 1;
+    //Greater than
+    if(cmp == 1 && (tree.op == op_gt || tree.op == op_gt_equal)) out.r = 1;
+    //Less than
+    if(cmp == -1 && (tree.op == op_lt || tree.op == op_lt_equal)) out.r = 1;
+    return out;
+}
+//Converts the first two arguments to the same type for min, max, lerp and dist
+void sameTypeArgs(Value* args, int* needsFree) {
+    if(args[0].type == args[1].type) return;
+    int frees = convertToSameType(needsFree[0] + 2 * needsFree[1], args, args + 1);
+    needsFree[0] = frees & 1;
+    needsFree[1] = frees & 2;
+}
+BUILTIN(builtinMinMax) {
+    Value out = NULLVAL;
+    sameTypeArgs(args, needsFree);
+    if(args[0].type == value_num) {
+        bool isGreater = args[0].r > args[1].r;
+        bool expectsGreater = tree.op == op_max;
+        if(isGreater ^ expectsGreater) out = args[1];
+        else out = args[0];
+    }
+    if(args[0].type == value_vec) {
+        Vector one = args[0].vec;
+        Vector two = args[1].vec;
+        int width = one.width > two.width ? one.width : two.width;
+        int height = one.height > two.height ? one.height : two.height;
+        out.type = value_vec;
+        out.vec = newVec(width, height);
+        *isFree = 1;
+        for(int i = 0;i < width;i++) for(int j = 0;j < height;j++) {
+            Number oneNum = NULLNUM;
+            Number twoNum = NULLNUM;
+            if(i < one.width && j < one.height) oneNum = one.val[i + j * one.width];
+            if(i < two.width && j < two.height) twoNum = two.val[i + j * two.width];
+            if((oneNum.r > twoNum.r) ^ (tree.op == op_max)) out.vec.val[i + j * width] = twoNum;
+            else out.vec.val[i + j * width] = oneNum;
+        }
+    }
+    return out;
+}
+BUILTIN(builtinLerp) {
+    sameTypeArgs(args, needsFree);
+    //(1 - c) * one + c * two;
+    Value c = computeTree(tree.branch[2], args, argLen, localVars);
+    Value negativeC = valNegate(c);
+    Value oneSubC = valAdd(newValNum(1, 0, 0), negativeC);
+    Value cTimesTwo = valMult(c, args[1]);
+    Value oneSubCTimesTwo = valMult(oneSubC, args[0]);
+    Value out = valAdd(cTimesTwo, oneSubCTimesTwo);
+    *isFree = 1;
+    freeValue(c);
+    freeValue(negativeC);
+    freeValue(oneSubC);
+    freeValue(cTimesTwo);
+    freeValue(oneSubCTimesTwo);
+    return out;
+}
+BUILTIN(builtinDist) {
+    Value out = NULLVAL;
+    sameTypeArgs(args, needsFree);
+    if(args[0].type == value_num) out = newValNum(sqrt(pow(fabs(args[0].r - args[1].r), 2) + pow(fabs(args[0].i - args[1].i), 2)), 0, 0);
+    if(args[0].type == value_vec) {
+        Vector one = args[0].vec;
+        Vector two = args[1].vec;
+        int width = one.width > two.width ? one.width : two.width;
+        int height = one.height > two.height ? one.height : two.height;
+        for(int i = 0;i < width;i++) for(int j = 0;j < height;j++) {
+            Number oneNum, twoNum;
+            if(i < one.width && j < one.height) oneNum = one.val[i + j * one.width];
+            else oneNum = NULLNUM;
+            if(i < two.width && j < two.height) twoNum = two.val[i + j * two.width];
+            else twoNum = NULLNUM;
+            out.r += pow(oneNum.r - twoNum.r, 2) + pow(oneNum.i - twoNum.i, 2);
+        }
+        out.r = sqrt(out.r);
+    }
+    return out;
+}
+//Binary Operations
+BUILTIN(builtinNot) {
+    Value out = NULLVAL;
+    if(args[0].type == value_num) out.num = compBinNot(args[0].num);
+    if(args[0].type == value_vec) {
+        setOutToArgs(0);
+        for(int i = 0;i < out.vec.total;i++) out.vec.val[i] = compBinNot(out.vec.val[i]);
+    }
+    return out;
+}
+BUILTIN(builtinBitwise) {
+    //Apply the binary operations properly with vectors
+    const Number(*funcs[])(Number, Number) = { &compBinAnd,&compBinOr,&compBinXor,&compBinLs,&compBinRs };
+    const bool useMax[] = { false,true,true,true,true };
+    int op = tree.op - op_and;
+    *isFree = 1;
+    return applyBinaryToVector(args[0], args[1], funcs[op], useMax[op], false);
+}
+//Constants
+BUILTIN(builtinPi) {
+    if(useArb && useBall) {
+        *isFree = 1;
+        return newValBall(arbToBall(arb_pi(globalAccuracy), 1), 0);
+    }
+    if(useArb) {
+        *isFree = 1;
+        return newValArb(arb_pi(globalAccuracy), 0);
+    }
+    if(useDD) return newValDD(newDD(ddPi[0], ddPi[1]), 0);
+    return newValNum(3.1415926535897932, 0, 0);
+}
+BUILTIN(builtinE) {
+    if(useArb && useBall) {
+        *isFree = 1;
+        return newValBall(arbToBall(arb_e(globalAccuracy), 1), 0);
+    }
+    if(useArb) {
+        *isFree = 1;
+        return newValArb(arb_e(globalAccuracy), 0);
+    }
+    if(useDD) return newValDD(ddExp(newDD(1, 0)), 0);
+    return newValNum(2.718281828459045, 0, 0);
+}
+BUILTIN(builtinPhi) {
+    if(useArb && useBall) {
+        *isFree = 1;
+        return newValBall(arbToBall(getArbConstant(arbconst_phi, globalAccuracy), 1), 0);
+    }
+    if(useArb) {
+        *isFree = 1;
+        return newValArb(getArbConstant(arbconst_phi, globalAccuracy), 0);
+    }
+    if(useDD) return newValDD(ddDivide(ddAdd(newDD(1, 0), ddSqrt(newDD(5, 0))), newDD(2, 0)), 0);
+    return newValNum(1.618033988749894, 0, 0);
+}
+BUILTIN(builtinTypeof) {
+    Value out = NULLVAL;
+    out.r = args[0].type;
+    return out;
+}
+BUILTIN(builtinAns) {
+    if(historyCount == 0) {
+        error("no previous answer", NULL);
+        return NULLVAL;
+    }
+    return history[historyCount - 1];
+}
+BUILTIN(builtinHist) {
+    int i = (int)floor(getR(args[0]));
+    if(i < 0) {
+        if(i < -historyCount) {
+            error("history too short", NULL);
+            return NULLVAL;
+        }
+        return history[historyCount + i];
+    }
+    if(i >= historyCount) {
+        error("history too short", NULL);
+        return NULLVAL;
+    }
+    return history[i];
+}
+BUILTIN(builtinHistNum) {
+    return newValNum(historyCount, 0, 0);
+}
+BUILTIN(builtinRand) {
+    return newValNum((double)rand() / RAND_MAX, 0, 0);
+}
+//Run, Sum, and Product
+BUILTIN(builtinRun) {
+    Value out = NULLVAL;
+    if(args[0].type == value_string) {
+        char name[strlen(args[0].string) + 1];
+        strcpy(name, args[0].string);
+        lowerCase(name);
+        Tree op = findFunction(name, false, NULL, NULL);
+        if(op.optype == optype_builtin) {
+            //TODO: this unecessarily recomputes args[1], args[2]...
+            Tree toCompute = NULLOPERATION;
+            toCompute.op = op.op;
+            toCompute.argCount = tree.argCount - 1;
+            toCompute.branch = tree.branch + 1;
+            toCompute.checkedArgs = 0;
+            out = computeTree(toCompute, arguments, argLen, localVars);
+        }
+        else if(op.optype == optype_custom) {
+            if(customfunctions[op.op].argCount > tree.argCount - 1) error("not enough args in run function");
+            else out = runFunction(customfunctions[op.op], args + 1);
+        }
+        else error("function '%s' not found", args[0].string);
+        *isFree = 1;
+        return out;
+    }
+    int argCount = tree.argCount - 1;
+    int requiredArgs = argListLen(args[0].argNames);
+    if(argCount < requiredArgs) {
+        error("not enough args in run function");
+        return out;
+    }
+    *isFree = 1;
+    return runAnonymousFunction(args[0], args + 1);
+}
+BUILTIN(builtinSumProduct) {
+    Value out = NULLVAL;
+    int argCount = argListLen(args[0].argNames);
+    if(argCount < 2) argCount = 2;
+    Value tempArgs[argCount];
+    memset(tempArgs, 0, sizeof(tempArgs));
+    double loopArgs[3];
+    loopArgs[0] = getR(args[1]);
+    loopArgs[1] = getR(args[2]);
+    if(tree.argCount > 3) loopArgs[2] = getR(args[3]);
+    else loopArgs[2] = 1;
+    double i;
+    int loopCount = 0;
+    *isFree = 1;
+    if(tree.op == op_sum) {
+        out = newValNum(0, 0, 0);
+        tempArgs[0] = newValNum(0, 0, 0);
+        for(i = loopArgs[0];i <= loopArgs[1];i += loopArgs[2]) {
+            tempArgs[0].r = i;
+            tempArgs[1].r = loopCount;
+            Value current = runAnonymousFunction(args[0], tempArgs);
+            Value new;
+            if(current.type == value_string && i == loopArgs[0])  new = current;
+            else {
+                new = valAdd(out, current);
+                freeValue(out);
+                freeValue(current);
             }
-            *isFree = 1;
-            goto ret;
-        }
-        //Matrix functions
-        if(tree.op < 107) {
-            if(tree.op == op_vector) {
-                int width = tree.argWidth;
-                int height = tree.argCount / tree.argWidth;
-                int i;
-                Vector vec = newVec(width, height);
-                for(i = 0;i < vec.total;i++) vec.val[i] = getNum(args[i]);
-                *isFree = 1;
-                out.type = value_vec;
-                out.vec = vec;
-                goto ret;
+            if(globalError) { freeValue(new);return NULLVAL; }
+            out = new;
+            loopCount++;
+            if(loopCount > 100000) { error("infinite loop detected");return out; }
+        }
+    }
+    if(tree.op == op_product) {
+        out = newValNum(1, 0, 0);
+        tempArgs[0] = newValNum(0, 0, 0);
+        for(i = loopArgs[0]; i <= loopArgs[1];i += loopArgs[2]) {
+            tempArgs[0].r = i;
+            tempArgs[1].r = loopCount;
+            Value current = runAnonymousFunction(args[0], tempArgs);
+            Value new = valMult(out, current);
+            freeValue(out);
+            freeValue(current);
+            if(globalError) { freeValue(new);return NULLVAL; }
+            out = new;
+            loopCount++;
+            if(loopCount > 100000) { error("infinite loop detected");return out; }
+        }
+    }
+    return out;
+}
+//Matrix functions
+BUILTIN(builtinVector) {
+    int width = tree.argWidth;
+    int height = tree.argCount / tree.argWidth;
+    int i;
+    //Any arbitrary-precision member makes an arbitrary-precision vector
+    int accu = 0;
+    for(i = 0;i < tree.argCount;i++) {
+        if(args[i].type == value_arb && args[i].numArb->r.accu > accu) accu = args[i].numArb->r.accu;
+        if(args[i].type == value_arbvec && args[i].vecArb->accu > accu) accu = args[i].vecArb->accu;
+    }
+    *isFree = 1;
+    if(accu != 0) {
+        Value out = newValArbVec(width, height, accu);
+        for(i = 0;i < tree.argCount;i++) {
+            ArbNum num = getArbNum(args[i]);
+            arbNumSetInto(out.vecArb->val + i, num);
+            freeArbNum(num);
+        }
+        return out;
+    }
+    Value out;
+    out.type = value_vec;
+    out.vec = newVec(width, height);
+    for(i = 0;i < out.vec.total;i++) out.vec.val[i] = getNum(args[i]);
+    return out;
+}
+BUILTIN(builtinDimension) {
+    int ret = 1;
+    if(args[0].type == value_vec) {
+        if(tree.op == op_width) ret = args[0].vec.width;
+        if(tree.op == op_height) ret = args[0].vec.height;
+        if(tree.op == op_length) ret = args[0].vec.total;
+    }
+    else if(args[0].type == value_arbvec) {
+        if(tree.op == op_width) ret = args[0].vecArb->width;
+        if(tree.op == op_height) ret = args[0].vecArb->height;
+        if(tree.op == op_length) ret = args[0].vecArb->total;
+    }
+    else if(args[0].type == value_string) {
+        if(tree.op == op_length || tree.op == op_width) ret = strlen(args[0].string);
+        if(tree.op == op_height) ret = 1;
+    }
+    return newValNum(ret, 0, 0);
+}
+BUILTIN(builtinGe) {
+    Value out = NULLVAL;
+    int x = 0, y = 0;
+    x = getR(args[1]);
+    if(tree.argCount == 3) y = getR(args[2]);
+    if(x < 0 || y < 0) return NULLVAL;
+    if(args[0].type == value_num) {
+        if(x == 0 && y == 0) out = args[0];
+        else return newValNum(0, 0, 0);
+    }
+    else if(args[0].type == value_vec) {
+        int width = args[0].vec.width;
+        out.type = value_num;
+        if(x + y * width >= args[0].vec.total) {
+            error("ge out of bounds");
+            return out;
+        }
+        if(x >= width || y >= args[0].vec.height) out = NULLVAL;
+        else out.num = args[0].vec.val[x + y * width];
+    }
+    else if(args[0].type == value_arbvec) {
+        ArbVec* vec = args[0].vecArb;
+        if(x >= vec->width || y >= vec->height) {
+            error("ge out of bounds");
+            return out;
+        }
+        ArbNum num = vec->val[x + y * vec->width];
+        num.r = copyArb(num.r);
+        num.i = copyArb(num.i);
+        out = newValArbNum(num, num.u);
+        *isFree = 1;
+    }
+    else if(args[0].type == value_string) {
+        char ch = 0;
+        if(y != 0);
+        else if(x<0 || x>strlen(args[0].string));
+        else ch = args[0].string[x];
+        out = newValNum(ch, 0, 0);
+    }
+    return out;
+}
+BUILTIN(builtinFill) {
+    Value out = NULLVAL;
+    int width = getR(args[1]);
+    int height = 1;
+    if(tree.argCount > 2) height = getR(args[2]);
+    if(width * height >= 0x7FFF || width * height < 1) {
+        if(width * height > 0) error("vector size too large");
+        else error("vector size cannot be negative or zero");
+        return out;
+    }
+    out.type = value_vec;
+    out.vec = newVec(width, height);
+    *isFree = 1;
+    if(args[0].type == value_func) {
+        int argCount = argListLen(args[0].argNames);
+        if(argCount < 3) argCount = 3;
+        Value funcArgs[argCount];
+        memset(funcArgs, 0, sizeof(funcArgs));
+        for(int j = 0;j < height;j++) for(int i = 0;i < width;i++) {
+            funcArgs[0].r = i;
+            funcArgs[1].r = j;
+            funcArgs[2].r = i + j * width;
+            Value cell = runAnonymousFunction(args[0], funcArgs);
+            out.vec.val[i + j * width] = getNum(cell);
+            freeValue(cell);
+            if(globalError) return out;
+        }
+    }
+    if(args[0].type == value_vec || args[0].type == value_num) {
+        Number num = getNum(args[0]);
+        for(int j = 0;j < height;j++) for(int i = 0;i < width;i++) {
+            out.vec.val[i + j * width] = num;
+        }
+    }
+    return out;
+}
+BUILTIN(builtinMap) {
+    Value out;
+    setOutToArgs(0);
+    if(out.type == value_num) {
+        out = newValMatScalar(value_vec, out.num);
+        *isFree = 1;
+    }
+    bool isString = out.type == value_string;
+    Value funcArgs[4];
+    memset(funcArgs, 0, sizeof(funcArgs));
+    int length = 0, width = 0;
+    if(isString) length = strlen(out.string), width = length;
+    else length = out.vec.total, width = out.vec.width;
+    for(int i = 0;i < length;i++) {
+        if(isString) funcArgs[0].r = out.string[i];
+        else funcArgs[0].num = out.vec.val[i];
+        funcArgs[1].r = i % width;
+        funcArgs[2].r = i / width;
+        funcArgs[3].r = i;
+        Value cell = runAnonymousFunction(args[1], funcArgs);
+        if(isString) out.string[i] = getR(cell);
+        else out.vec.val[i] = getNum(cell);
+        freeValue(cell);
+    }
+    return out;
+}
+BUILTIN(builtinDet) {
+    Value out = NULLVAL;
+    if(args[0].type == value_num || args[0].type == value_arb) {
+        out = args[0];
+    }
+    else if(args[0].type == value_arbvec) {
+        if(args[0].vecArb->width != args[0].vecArb->height) {
+            error("Cannot calculate determinant of non-square matrix", NULL);
+            return out;
+        }
+        ArbNum det = arbDeterminant(args[0].vecArb);
+        out = newValArbNum(det, 0);
+        *isFree = 1;
+    }
+    else if(args[0].vec.width != args[0].vec.height) {
+        error("Cannot calculate determinant of non-square matrix", NULL);
+        return out;
+    }
+    else out.num = determinant(args[0].vec);
+    return out;
+}
+BUILTIN(builtinTranspose) {
+    *isFree = 1;
+    if(args[0].type == value_arbvec) return arbTranspose(args[0].vecArb);
+    if(args[0].type == value_num) { args[0] = newValMatScalar(value_vec, args[0].num);needsFree[0] = 1; }
+    Value out;
+    out.type = value_vec;
+    out.vec = transpose(args[0].vec);
+    return out;
+}
+BUILTIN(builtinMatMult) {
+    Value out = NULLVAL;
+    if(args[0].type == value_arbvec || args[1].type == value_arbvec) {
+        for(int i = 0;i < 2;i++) if(args[i].type != value_arbvec) {
+            Value converted = arbVecFromValue(args[i]);
+            if(needsFree[i]) freeValue(args[i]);
+            args[i] = converted;
+            needsFree[i] = 1;
+        }
+        if(args[0].vecArb->width != args[1].vecArb->height) {
+            error("matrix size error in mat_mult", NULL);
+            return out;
+        }
+        *isFree = 1;
+        return arbMatMult(args[0].vecArb, args[1].vecArb);
+    }
+    if(args[0].type == value_num) args[0] = newValMatScalar(value_vec, args[0].num);
+    if(args[1].type == value_num) args[1] = newValMatScalar(value_vec, args[1].num);
+    if(args[0].vec.width != args[1].vec.height) {
+        error("matrix size error in mat_mult", NULL);
+        return out;
+    }
+    out.type = value_vec;
+    out.vec = matMult(args[0].vec, args[1].vec);
+    *isFree = 1;
+    return out;
+}
+BUILTIN(builtinMatInv) {
+    Value out = NULLVAL;
+    if(args[0].type == value_arbvec) {
+        if(args[0].vecArb->width != args[0].vecArb->height) {
+            error("cannot take inverse of non-square matrix");
+            return out;
+        }
+        *isFree = 1;
+        return arbMatInv(args[0].vecArb);
+    }
+    if(args[0].type == value_num) args[0] = newValMatScalar(value_vec, args[0].num);
+    if(args[0].vec.width != args[0].vec.height) {
+        error("cannot take inverse of non-square matrix");
+        return out;
+    }
+    out.type = value_vec;
+    out.vec = matInv(args[0].vec);
+    *isFree = 1;
+    return out;
+}
+//String functions
+BUILTIN(builtinString) {
+    Value out = NULLVAL;
+    if(args[0].type == value_string) {
+        setOutToArgs(0);
+        return out;
+    }
+    //Get base
+    int base = 10;
+    if(tree.argCount > 1) base = getR(args[1]);
+    if(base < 2 || base > 36) {
+        error("base out of bounds");
+        return out;
+    }
+    //Convert to string
+    out.type = value_string;
+    out.string = valueToString(args[0], base);
+    *isFree = 1;
+    return out;
+}
+BUILTIN(builtinEval) {
+    int base = 0;
+    if(tree.argCount > 1) base = getR(args[0]);
+    *isFree = 1;
+    return calculate(args[0].string, base);
+}
+BUILTIN(builtinPrint) {
+    if(args[0].type == value_string) printString(args[0]);
+    else {
+        Value toPrint = NULLVAL;
+        toPrint.type = value_string;
+        toPrint.string = valueToString(args[0], 10);
+        printString(toPrint);
+        free(toPrint.string);
+    }
+    return NULLVAL;
+}
+BUILTIN(builtinError) {
+    if(args[0].type == value_string) error("%s", args[0].string);
+    else {
+        char* message = valueToString(args[0], 10);
+        error("%s", message);
+        free(message);
+    }
+    return NULLVAL;
+}
+BUILTIN(builtinReplace) {
+    Value out;
+    int stringLen = strlen(args[0].string);
+    int searchLen = strlen(args[1].string);
+    int replaceLen = strlen(args[2].string);
+    int matches[stringLen + 1];
+    int matchCount = 0;
+    //Find matches
+    for(int i = 0;i < stringLen - searchLen;i++)
+        if(memcmp(args[0].string + i, args[1].string, searchLen) == 0)
+            matches[++matchCount] = i;
+    //Set maximum replace count
+    if(tree.argCount > 3) if(matchCount > getR(args[3])) matchCount = getR(args[3]);
+    matches[0] = -searchLen;
+    matches[matchCount + 1] = stringLen;
+    //Create return buffer
+    out.string = calloc(stringLen + matchCount * (replaceLen - searchLen) + 1, 1);
+    int outPos = 0;
+    int readPos = 0;
+    for(int i = 0;i <= matchCount;i++) {
+        //Copy unreplaced section
+        int len = matches[i + 1] - matches[i] - searchLen;
+        memcpy(out.string + outPos, args[0].string + readPos, len);
+        outPos += len;
+        readPos += len;
+        //Copy section to replace
+        if(i != matchCount) {
+            strcpy(out.string + outPos, args[2].string);
+            outPos += replaceLen;
+            readPos += searchLen;
+        }
+    }
+    out.type = value_string;
+    *isFree = 1;
+    return out;
+}
+BUILTIN(builtinIndexOf) {
+    Value out = NULLVAL;
+    int searchLen = strlen(args[0].string);
+    int matchLen = strlen(args[1].string);
+    //Find start (if argument is present)
+    int start = 0;
+    if(tree.argCount > 2) start = getR(args[2]);
+    if(start < 0) start += searchLen;
+    if(start < 0) { error("start index out of bounds");return out; }
+    //Main loop
+    out.r = -1;
+    for(int i = start;i < searchLen - matchLen + 1;i++) {
+        if(memcmp(args[0].string + i, args[1].string, matchLen) == 0) { out.r = i;break; }
+    }
+    return out;
+}
+BUILTIN(builtinSubstr) {
+    Value out = NULLVAL;
+    int stringLen = strlen(args[0].string);
+    //Get Range
+    int start = getR(args[1]);
+    int end = stringLen;
+    if(tree.argCount > 2) end = getR(args[2]);
+    //Negative indices
+    if(start < 0) start += stringLen;
+    if(end < 0) start += stringLen;
+    //If indices out of range
+    if(end < 0 || start < 0 || start >= stringLen || end > stringLen) {
+        error("substring range out of bounds");
+        return out;
+    }
+    //If start is before end
+    if(end < start) {
+        int temp = start;
+        start = end;
+        end = temp;
+    }
+    //Copy string
+    int len = end - start;
+    if(needsFree[0]) {
+        out.string = args[0].string + start;
+        args[0].string[end] = 0;
+        needsFree[0] = 0;
+    }
+    else {
+        out.string = calloc(len + 1, 1);
+        memcpy(out.string, args[0].string + start, len);
+    }
+    out.type = value_string;
+    *isFree = 1;
+    return out;
+}
+BUILTIN(builtinLowercase) {
+    Value out;
+    setOutToArgs(0);
+    //Replace characters
+    for(int i = 0;out.string[i] != 0;i++)
+        if(out.string[i] >= 'A' && out.string[i] <= 'Z') out.string[i] += 32;
+    return out;
+}
+BUILTIN(builtinUppercase) {
+    Value out;
+    setOutToArgs(0);
+    //Replace characters
+    for(int i = 0;out.string[i] != 0;i++)
+        if(out.string[i] >= 'a' && out.string[i] <= 'z') out.string[i] -= 32;
+    return out;
+}
+#undef setOutToArgs
+typedef BUILTIN((*BuiltinHandler));
+#undef BUILTIN
+const BuiltinHandler builtinHandlers[immutableFunctions] = {
+    [op_i] = &builtinI,
+    [op_neg] = &builtinNeg,
+    [op_pow] = &builtinPow,
+    [op_mod] = &builtinMod,
+    [op_mult] = &builtinMult,
+    [op_div] = &builtinDiv,
+    [op_add] = &builtinAdd,
+    [op_sub] = &builtinSub,
+    [op_sin] = &builtinTrig,[op_cos] = &builtinTrig,[op_tan] = &builtinTrig,
+    [op_csc] = &builtinTrig,[op_sec] = &builtinTrig,[op_cot] = &builtinTrig,
+    [op_sinh] = &builtinTrig,[op_cosh] = &builtinTrig,[op_tanh] = &builtinTrig,
+    [op_asin] = &builtinTrig,[op_acos] = &builtinTrig,[op_atan] = &builtinTrig,
+    [op_acsc] = &builtinTrig,[op_asec] = &builtinTrig,[op_acot] = &builtinTrig,
+    [op_asinh] = &builtinTrig,[op_acosh] = &builtinTrig,[op_atanh] = &builtinTrig,
+    [op_sqrt] = &builtinSqrt,
+    [op_cbrt] = &builtinCbrt,
+    [op_exp] = &builtinExp,
+    [op_ln] = &builtinLn,
+    [op_logten] = &builtinLogTen,
+    [op_log] = &builtinLog,
+    [op_fact] = &builtinFact,
+    [op_isprime] = &builtinNumberTheory,[op_gcd] = &builtinNumberTheory,[op_modpow] = &builtinNumberTheory,
+    [op_sgn] = &builtinSgn,
+    [op_abs] = &builtinAbs,
+    [op_arg] = &builtinArg,
+    [op_round] = &builtinRound,[op_floor] = &builtinRound,[op_ceil] = &builtinRound,
+    [op_getr] = &builtinGetR,
+    [op_geti] = &builtinGetI,
+    [op_getu] = &builtinGetU,
+    [op_equal] = &builtinCompare,[op_not_equal] = &builtinCompare,[op_lt] = &builtinCompare,
+    [op_gt] = &builtinCompare,[op_lt_equal] = &builtinCompare,[op_gt_equal] = &builtinCompare,
+    [op_min] = &builtinMinMax,[op_max] = &builtinMinMax,
+    [op_lerp] = &builtinLerp,
+    [op_dist] = &builtinDist,
+    [op_not] = &builtinNot,
+    [op_and] = &builtinBitwise,[op_or] = &builtinBitwise,[op_xor] = &builtinBitwise,
+    [op_ls] = &builtinBitwise,[op_rs] = &builtinBitwise,
+    [op_pi] = &builtinPi,
+    [op_phi] = &builtinPhi,
+    [op_e] = &builtinE,
+    [op_typeof] = &builtinTypeof,
+    [op_ans] = &builtinAns,
+    [op_hist] = &builtinHist,
+    [op_histnum] = &builtinHistNum,
+    [op_rand] = &builtinRand,
+    [op_run] = &builtinRun,
+    [op_sum] = &builtinSumProduct,[op_product] = &builtinSumProduct,
+    [op_vector] = &builtinVector,
+    [op_width] = &builtinDimension,[op_height] = &builtinDimension,[op_length] = &builtinDimension,
+    [op_ge] = &builtinGe,
+    [op_fill] = &builtinFill,
+    [op_map] = &builtinMap,
+    [op_det] = &builtinDet,
+    [op_transpose] = &builtinTranspose,
+    [op_mat_mult] = &builtinMatMult,
+    [op_mat_inv] = &builtinMatInv,
+    [op_string] = &builtinString,
+    [op_eval] = &builtinEval,
+    [op_print] = &builtinPrint,
+    [op_error] = &builtinError,
+    [op_replace] = &builtinReplace,
+    [op_indexof] = &builtinIndexOf,
+    [op_substr] = &builtinSubstr,
+    [op_lowercase] = &builtinLowercase,
+    [op_uppercase] = &builtinUppercase,
+};
+const char* const valueTypeNames[] = { "number","vector","anonymous function","arbitrary-precision number","string","arbitrary-precision vector","ball","double-double number","decimal number" };
+#pragma endregion
+Value computeTreeMicro(Tree tree, const Value* arguments, int argLen, Value* localVars, int* isFree) {
+    if(tree.optype == optype_builtin) {
+        if(tree.op == op_val) return tree.value;
+        Value out = NULLVAL;
+        int needsFree[tree.argCount];
+        memset(needsFree, 0, sizeof(needsFree));
+        //Compute each branch
+        Value args[tree.argCount];
+        memset(args, 0, sizeof(args));
+        const unsigned short* acceptableArgs = stdfunctions[tree.op].inputs;
+        for(int i = 0;i < tree.argCount;i++) {
+            args[i] = computeTreeMicro(tree.branch[i], arguments, argLen, localVars, needsFree + i);
+            if(globalError) goto ret;
+            //Arguments that were known to be accepted when the tree was built are not checked again
+            if(i < 16 && (tree.checkedArgs >> i & 1)) continue;
+            unsigned short accepted = i < 5 ? acceptableArgs[i] : 0;
+            //Double-doubles become Arbs in functions that do not support them
+            if(args[i].type == value_dd && (accepted & (2 << value_dd)) == 0) {
+                args[i] = ddValueToArb(args[i]);
+                needsFree[i] = 1;
             }
-            else if(tree.op == op_width || tree.op == op_height || tree.op == op_length) {
-                int ret = 1;
-                if(args[0].type == value_vec) {
-                    if(tree.op == op_width) ret = args[0].vec.width;
-                    if(tree.op == op_height) ret = args[0].vec.height;
-                    if(tree.op == op_length) ret = args[0].vec.total;
-                }
-                else if(args[0].type == value_string) {
-                    if(tree.op == op_length || tree.op == op_width) ret = strlen(args[0].string);
-                    if(tree.op == op_height) ret = 1;
-                }
-                out = newValNum(ret, 0, 0);
-                goto ret;
+            //So do decimal values
+            if(args[i].type == value_dec && (accepted & (2 << value_dec)) == 0) {
+                Value dec = args[i];
+                args[i] = decValueToArb(dec);
+                if(needsFree[i]) freeValue(dec);
+                needsFree[i] = 1;
             }
-            else if(tree.op == op_ge) {
-                int x = 0, y = 0;
-                x = getR(args[1]);
-                if(tree.argCount == 3) y = getR(args[2]);
-                if(x < 0 || y < 0) return NULLVAL;
-                if(args[0].type == value_num) {
-                    if(x == 0 && y == 0) out = args[0];
-                    else return newValNum(0, 0, 0);
-                }
-                else if(args[0].type == value_vec) {
-                    int width = args[0].vec.width;
-                    out.type = value_num;
-                    if(x + y * width >= args[0].vec.total) {
-                        error("ge out of bounds");
-                        goto ret;
-                    }
-                    if(x >= width || y >= args[0].vec.height) out = NULLVAL;
-                    else out.num = args[0].vec.val[x + y * width];
-                }
-                else if(args[0].type == value_string) {
-                    char ch = 0;
-                    if(y != 0);
-                    else if(x<0 || x>strlen(args[0].string));
-                    else ch = args[0].string[x];
-                    out = newValNum(ch, 0, 0);
-                }
+            if(args[i].type<0 || args[i].type>value_dec) {
+                error("Invalid error value in call to %s", stdfunctions[tree.op].name);
                 goto ret;
             }
-            else if(tree.op == op_fill) {
-                int width = getR(args[1]);
-                int height = 1;
-                if(tree.argCount > 2) height = getR(args[2]);
-                if(width * height >= 0x7FFF || width * height < 1) {
-                    if(width * height > 0) error("vector size too large");
-                    else error("vector size cannot be negative or zero");
-                    goto ret;
-                }
-                out;
-                out.type = value_vec;
-                out.vec = newVec(width, height);
-                *isFree = 1;
-                if(args[0].type == value_func) {
-                    int argCount = argListLen(args[0].argNames);
-                    if(argCount < 3) argCount = 3;
-                    Value funcArgs[argCount];
-                    memset(funcArgs, 0, sizeof(funcArgs));
-                    for(int j = 0;j < height;j++) for(int i = 0;i < width;i++) {
-                        funcArgs[0].r = i;
-                        funcArgs[1].r = j;
-                        funcArgs[2].r = i + j * width;
-                        Value cell = runAnonymousFunction(args[0], funcArgs);
-                        out.vec.val[i + j * width] = getNum(cell);
-                        freeValue(cell);
-                        if(globalError) goto ret;
-                    }
-                }
-                if(args[0].type == value_vec || args[0].type == value_num) {
-                    Number num = getNum(args[0]);
-                    for(int j = 0;j < height;j++) for(int i = 0;i < width;i++) {
-                        out.vec.val[i + j * width] = num;
-                    }
-                }
-            }
-            else if(tree.op == op_map) {
-                setOutToArgs(0);
-                if(out.type == value_num) {
-                    out = newValMatScalar(value_vec, out.num);
-                    *isFree = 1;
-                }
-                bool isString = args[0].type == value_string;
-                Value funcArgs[4];
-                memset(funcArgs, 0, sizeof(funcArgs));
-                int i, j;
-                int length = 0, width = 0;
-                if(isString) length = strlen(out.string), width = length;
-                else length = out.vec.total, width = out.vec.width;
-                for(int i = 0;i < length;i++) {
-                    if(isString) funcArgs[0].r = out.string[i];
-                    else funcArgs[0].num = out.vec.val[i];
-                    funcArgs[1].r = i % width;
-                    funcArgs[2].r = i / width;
-                    funcArgs[3].r = i;
-                    Value cell = runAnonymousFunction(args[1], funcArgs);
-                    if(isString) out.string[i] = getR(cell);
-                    else out.vec.val[i] = getNum(cell);
-                    freeValue(cell);
-                }
-            }
-            else if(tree.op == op_det) {
-                if(args[0].type == value_num) {
-                    out = args[0];
-                }
-                else if(args[0].vec.width != args[0].vec.height) {
-                    error("Cannot calculate determinant of non-square matrix", NULL);
-                    goto ret;
-                }
-                else out.num = determinant(args[0].vec);
-            }
-            else if(tree.op == op_transpose) {
-                if(args[0].type == value_num) { args[0] = newValMatScalar(value_vec, args[0].num);needsFree[0] = 1; }
-                out.type = value_vec;
-                out.vec = transpose(args[0].vec);
-                *isFree = 1;
-            }
-            else if(tree.op == op_mat_mult) {
-                if(args[0].type == value_num) args[0] = newValMatScalar(value_vec, args[0].num);
-                if(args[1].type == value_num) args[1] = newValMatScalar(value_vec, args[1].num);
-                if(args[0].vec.width != args[1].vec.height) {
-                    error("matrix size error in mat_mult", NULL);
-                    goto ret;
-                }
-                out.type = value_vec;
-                out.vec = matMult(args[0].vec, args[1].vec);
-                *isFree = 1;
-            }
-            else if(tree.op == op_mat_inv) {
-                if(args[0].type == value_num) args[0] = newValMatScalar(value_vec, args[0].num);
-                if(args[0].vec.width != args[0].vec.height) {
-                    error("cannot take inverse of non-square matrix");
-                    goto ret;
-                }
-                out.type = value_vec;
-                out.vec = matInv(args[0].vec);
-                *isFree = 1;
-            }
-            goto ret;
-        }
-        //String functions
-        if(tree.op < 120) {
-            if(tree.op == op_string) {
-                if(args[0].type == value_string) {
-                    setOutToArgs(0);
-                }
-                else {
-                    //Get base
-                    int base = 10;
-                    if(tree.argCount > 1) base = getR(args[1]);
-                    if(base < 2 || base > 36) {
-                        error("base out of bounds");
-                        goto ret;
-                    }
-                    //Convert to string
-                    out.type = value_string;
-                    out.string = valueToString(args[0], base);
-                    *isFree = 1;
-                }
-            }
-            else if(tree.op == op_eval) {
-                int base = 0;
-                if(tree.argCount > 1) base = getR(args[0]);
-                out = calculate(args[0].string, base);
-                *isFree = 1;
-            }
-            else if(tree.op == op_print) {
-                if(args[0].type == value_string) printString(args[0]);
-                else {
-                    Value toPrint = NULLVAL;
-                    toPrint.type = value_string;
-                    toPrint.string = valueToString(args[0], 10);
-                    printString(toPrint);
-                    free(toPrint.string);
-                }
-            }
-            else if(tree.op == op_error) {
-                if(args[0].type == value_string) error("%s", args[0].string);
-                else {
-                    char* message = valueToString(args[0], 10);
-                    error("%s", message);
-                    free(message);
-                }
+            if((accepted & (2 << args[i].type)) == 0) {
+                if(tree.op == op_run && i != 0) continue;
+                if(tree.op == op_vector) continue;
+                error("Invalid %s in call to %s", valueTypeNames[args[i].type], stdfunctions[tree.op].name);
                 goto ret;
             }
-            else if(tree.op == op_replace) {
-                int stringLen = strlen(args[0].string);
-                int searchLen = strlen(args[1].string);
-                int replaceLen = strlen(args[2].string);
-                int matches[stringLen + 1];
-                int matchCount = 0;
-                //Find matches
-                for(int i = 0;i < stringLen - searchLen;i++)
-                    if(memcmp(args[0].string + i, args[1].string, searchLen) == 0)
-                        matches[++matchCount] = i;
-                //Set maximum replace count
-                if(tree.argCount > 3) if(matchCount > getR(args[3])) matchCount = getR(args[3]);
-                matches[0] = -searchLen;
-                matches[matchCount + 1] = stringLen;
-                //Create return buffer
-                out.string = calloc(stringLen + matchCount * (replaceLen - searchLen) + 1, 1);
-                int outPos = 0;
-                int readPos = 0;
-                for(int i = 0;i <= matchCount;i++) {
-                    //Copy unreplaced section
-                    int len = matches[i + 1] - matches[i] - searchLen;
-                    memcpy(out.string + outPos, args[0].string + readPos, len);
-                    outPos += len;
-                    readPos += len;
-                    //Copy section to replace
-                    if(i != matchCount) {
-                        strcpy(out.string + outPos, args[2].string);
-                        outPos += replaceLen;
-                        readPos += searchLen;
-                    }
-                }
-                out.type = value_string;
-                *isFree = 1;
-            }
-            else if(tree.op == op_indexof) {
-                int searchLen = strlen(args[0].string);
-                int matchLen = strlen(args[1].string);
-                //Find start (if argument is present)
-                int start = 0;
-                if(tree.argCount > 2) start = getR(args[2]);
-                if(start < 0) start += searchLen;
-                if(start < 0) { error("start index out of bounds");goto ret; }
-                //Main loop
-                out.r = -1;
-                for(int i = start;i < searchLen - matchLen + 1;i++) {
-                    if(memcmp(args[0].string + i, args[1].string, matchLen) == 0) { out.r = i;break; }
-                }
-            }
-            else if(tree.op == op_substr) {
-                int stringLen = strlen(args[0].string);
-                //Get Range
-                int start = getR(args[1]);
-                int end = stringLen;
-                if(tree.argCount > 2) end = getR(args[2]);
-                //Negative indices
-                if(start < 0) start += stringLen;
-                if(end < 0) start += stringLen;
-                //If indices out of range
-                if(end < 0 || start < 0 || start >= stringLen || end > stringLen) {
-                    error("substring range out of bounds");
-                    goto ret;
-                }
-                //If start is before end
-                if(end < start) {
-                    int temp = start;
-                    start = end;
-                    end = temp;
-                }
-                //Copy string
-                int len = end - start;
-                if(needsFree[0]) {
-                    out.string = args[0].string + start;
-                    args[0].string[end] = 0;
-                    needsFree[0] = 0;
-                }
-                else {
-                    out.string = calloc(len + 1, 1);
-                    memcpy(out.string, args[0].string + start, len);
-                }
-                out.type = value_string;
-                *isFree = 1;
-            }
-            else if(tree.op == op_lowercase) {
-                setOutToArgs(0);
-                //Replace characters
-                for(int i = 0;out.string[i] != 0;i++)
-                    if(out.string[i] >= 'A' && out.string[i] <= 'Z') out.string[i] += 32;
-            }
-            else if(tree.op == op_uppercase) {
-                setOutToArgs(0);
-                //Replace characters
-                for(int i = 0;out.string[i] != 0;i++)
-                    if(out.string[i] >= 'a' && out.string[i] <= 'z') out.string[i] -= 32;
-            }
-            goto ret;
         }
+        if(builtinHandlers[tree.op] != NULL) out = builtinHandlers[tree.op](tree, args, needsFree, isFree, arguments, argLen, localVars);
     ret:
         for(int i = 0;i < tree.argCount;i++) if(needsFree[i]) freeValue(args[i]);
         return out;
@@ -1,10 +1,12 @@
 //compute.h contains header information for compute.c
 #ifndef COMPUTE_H
 #define COMPUTE_H 1
+#include <stdbool.h>
 typedef struct NumberStruct Number;
 typedef struct VectorStruct Vector;
 typedef struct TreeStruct Tree;
 typedef struct ValueStruct Value;
+typedef struct DoubleDoubleStruct DD;
 #define unit_t unsigned long long
 #pragma region Numbers
 /**
@@ -50,6 +52,23 @@ Number compTrig(int type, Number num);
  */
 Number compBinOp(int type, Number one, Number two);
 #pragma endregion
+#pragma region Double-Double
+DD newDD(double hi, double lo);
+DD ddAdd(DD one, DD two);
+DD ddNegate(DD one);
+DD ddSubtract(DD one, DD two);
+DD ddMult(DD one, DD two);
+DD ddDivide(DD one, DD two);
+DD ddSqrt(DD one);
+DD ddExp(DD one);
+//Returns ln(one) for one > 0
+DD ddLn(DD one);
+DD ddSin(DD one);
+DD ddCos(DD one);
+DD ddTan(DD one);
+DD ddAtan(DD one);
+DD ddPower(DD one, DD two);
+#pragma endregion
 #pragma region Vectors
 /**
  * Return the determinant of a square matrix
@@ -80,6 +99,15 @@ Vector newVecScalar(Number num);
  */
 Vector newVec(short width,short height);
 #pragma endregion
+#pragma region Arbitrary Precision
+typedef struct ArbStruct Arb;
+/**
+ * Writes an integer value to out as an Arb
+ * Errors and returns false if val is not an exact integer
+ * @param name Name of the function, for the error message
+ */
+bool getArbInteger(Value val, const char* name, Arb* out);
+#pragma endregion
 #pragma region Values
 Value valMult(Value one, Value two);
 Value valAdd(Value one, Value two);
@@ -257,52 +257,56 @@ const struct stdFunction stdfunctions[immutableFunctions] = {
 #define func 0b1000
 #define arb 0b10000
 #define string 0b100000
-#define any 0b111110
+#define arbvec 0b1000000
+#define ball 0b10000000
+#define dd 0b100000000
+#define dec 0b1000000000
+#define any 0b1111111110
     emptyFunction,
     function("i",{0}),
-    function("neg",{num | vec,0}),
-    function("pow",{num | vec,num | vec,0}),
+    function("neg",{num | vec | arb | arbvec | ball | dd | dec,0}),
+    function("pow",{num | vec | arb | ball | dd,num | vec | arb | ball | dd,0}),
     function("mod",{num | vec,num | vec,0}),
-    function("mult",{num | vec,num | vec,0}),
-    function("div",{num | vec,num | vec,0}),
-    function("add",{num | vec | string,num | vec | string,0}),
-    function("sub",{num | vec,num | vec,0}),
-    emptyFunction,
-    emptyFunction,
-    emptyFunction,
-    function("sin",{num | vec,0}),
-    function("cos",{num | vec,0}),
-    function("tan",{num | vec,0}),
-    function("csc",{num | vec,0}),
-    function("sec",{num | vec,0}),
-    function("cot",{num | vec,0}),
-    function("sinh",{num | vec,0}),
-    function("cosh",{num | vec,0}),
-    function("tanh",{num | vec,0}),
-    function("asin",{num | vec,0}),
-    function("acos",{num | vec,0}),
-    function("atan",{num | vec,0}),
-    function("acsc",{num | vec,0}),
-    function("asec",{num | vec,0}),
-    function("acot",{num | vec,0}),
-    function("asinh",{num | vec,0}),
-    function("acosh",{num | vec,0}),
-    function("atanh",{num | vec,0}),
-    emptyFunction,
-    emptyFunction,
-    function("sqrt",{num | vec,0}),
-    function("cbrt",{num | vec,0}),
-    function("exp",{num | vec,0}),
-    function("ln",{num | vec,0}),
-    function("logten",{num | vec,0}),
+    function("mult",{num | vec | arb | arbvec | ball | dd | dec,num | vec | arb | arbvec | ball | dd | dec,0}),
+    function("div",{num | vec | arb | arbvec | ball | dd,num | vec | arb | arbvec | ball | dd,0}),
+    function("add",{num | vec | arb | string | arbvec | ball | dd | dec,num | vec | arb | string | arbvec | ball | dd | dec,0}),
+    function("sub",{num | vec | arb | arbvec | ball | dd | dec,num | vec | arb | arbvec | ball | dd | dec,0}),
+    emptyFunction,
+    emptyFunction,
+    emptyFunction,
+    function("sin",{num | vec | arb | ball | dd,0}),
+    function("cos",{num | vec | arb | ball | dd,0}),
+    function("tan",{num | vec | arb | ball | dd,0}),
+    function("csc",{num | vec | arb,0}),
+    function("sec",{num | vec | arb,0}),
+    function("cot",{num | vec | arb,0}),
+    function("sinh",{num | vec | arb,0}),
+    function("cosh",{num | vec | arb,0}),
+    function("tanh",{num | vec | arb,0}),
+    function("asin",{num | vec | arb,0}),
+    function("acos",{num | vec | arb,0}),
+    function("atan",{num | vec | arb | ball | dd,0}),
+    function("acsc",{num | vec | arb,0}),
+    function("asec",{num | vec | arb,0}),
+    function("acot",{num | vec | arb,0}),
+    function("asinh",{num | vec | arb,0}),
+    function("acosh",{num | vec | arb,0}),
+    function("atanh",{num | vec | arb,0}),
+    emptyFunction,
+    emptyFunction,
+    function("sqrt",{num | vec | arb | ball | dd,0}),
+    function("cbrt",{num | vec | arb,0}),
+    function("exp",{num | vec | arb | ball | dd,0}),
+    function("ln",{num | vec | arb | ball | dd,0}),
+    function("logten",{num | vec | arb,0}),
     function("log",{num | vec,num | vec,0}),
-    function("fact",{num | vec,0}),
-    emptyFunction,
-    emptyFunction,
-    emptyFunction,
+    function("fact",{num | vec | arb,0}),
+    function("isprime",{num | arb,0}),
+    function("gcd",{num | arb,num | arb,0}),
+    function("modpow",{num | arb,num | arb,num | arb,0}),
     emptyFunction,
     function("sgn",{num | vec,0}),
-    function("abs",{num | vec,0}),
+    function("abs",{num | vec | ball | dd,0}),
     function("arg",{num | vec,0}),
     emptyFunction,
     function("round",{num | vec,0}),
@@ -355,16 +359,16 @@ const struct stdFunction stdfunctions[immutableFunctions] = {
     emptyFunction,
     emptyFunction,
     emptyFunction,
-    function("width",{vec | num,0}),
-    function("height",{vec | num,0}),
-    function("length",{vec | num | string,0}),
-    function("ge",{vec | num | string,num,num | optional,0}),
+    function("width",{vec | num | arbvec,0}),
+    function("height",{vec | num | arbvec,0}),
+    function("length",{vec | num | string | arbvec,0}),
+    function("ge",{vec | num | string | arbvec,num | arb,num | arb | optional,0}),
     function("fill",{num | vec | func,num,num | optional,0}),
     function("map",{vec | string,func,0}),
-    function("det",{vec | num,0}),
-    function("transpose",{vec | num,0}),
-    function("mat_mult",{vec,vec,0}),
-    function("mat_inv",{vec,0}),
+    function("det",{vec | num | arbvec | arb,0}),
+    function("transpose",{vec | num | arbvec,0}),
+    function("mat_mult",{vec | arbvec,vec | arbvec,0}),
+    function("mat_inv",{vec | arbvec,0}),
     emptyFunction,
     emptyFunction,
     emptyFunction,
@@ -385,6 +389,10 @@ const struct stdFunction stdfunctions[immutableFunctions] = {
 #undef vec
 #undef func
 #undef arb
+#undef arbvec
+#undef ball
+#undef dd
+#undef dec
 #undef string
 #undef any
 };
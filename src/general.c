@@ -194,6 +194,7 @@ void cleanup() {
     }
     free(globalLocalVariableValues);
     free(globalLocalVariables);
+    freeArbCaches();
     //Delete preferences
     int preferenceLen = sizeof(preferences) / sizeof(struct Preference);
     for(int i = 0;i < preferenceLen;i++) {
@@ -232,12 +233,26 @@ Vector newVec(short width, short height) {
 //Values
 int convertToSameType(int free, Value* one, Value* two) {
     if(one->type == two->type) return free;
+    //Convert both to arbitrary-precision vectors if there is a vector and anything arbitrary-precision
+    bool hasArb = one->type == value_arb || two->type == value_arb || one->type == value_arbvec || two->type == value_arbvec;
+    bool hasVec = one->type == value_vec || two->type == value_vec || one->type == value_arbvec || two->type == value_arbvec;
+    if(hasArb && hasVec) {
+        if(one->type != value_arbvec) {
+            Value old = *one;
+            *one = arbVecFromValue(old);
+            if(free & 1) freeValue(old);
+            free |= 1;
+        }
+        if(two->type != value_arbvec) {
+            Value old = *two;
+            *two = arbVecFromValue(old);
+            if(free & 2) freeValue(old);
+            free |= 2;
+        }
+        return free;
+    }
     //Convert to Arb if one is arb
     if(one->type == value_arb || two->type == value_arb) {
-        if(one->type == value_vec || two->type == value_vec) {
-            error("Vectors do not have arbitrary precision support.");
-            return free;
-        }
         if(two->type == value_num) {
             //Swap pointers to make one the non-arb type.
             Value* temp = one;
@@ -290,10 +305,91 @@ Value newValNum(double r, double i, unit_t u) {
     out.u = u;
     return out;
 }
+Value newValArb(Arb r, unit_t u) {
+    Value out;
+    out.type = value_arb;
+    out.numArb = calloc(1, sizeof(ArbNum));
+    if(out.numArb == NULL) error(mallocError);
+    out.numArb->r = r;
+    out.numArb->u = u;
+    return out;
+}
+Value newValDD(DD dd, unit_t u) {
+    Value out;
+    out.type = value_dd;
+    out.dd = dd;
+    out.u = u;
+    return out;
+}
+Value newValDec(Arb r, unit_t u) {
+    Value out = newValArb(r, u);
+    out.type = value_dec;
+    return out;
+}
+Value newValBall(Ball b, unit_t u) {
+    Value out;
+    out.type = value_ball;
+    out.numBall = malloc(sizeof(BallNum));
+    if(out.numBall == NULL) error(mallocError);
+    out.numBall->b = b;
+    out.numBall->u = u;
+    return out;
+}
+Value newValArbVec(int width, int height, int accu) {
+    Value out;
+    out.type = value_arbvec;
+    ArbVec* vec = malloc(sizeof(ArbVec));
+    if(vec == NULL) error(mallocError);
+    vec->width = width;
+    vec->height = height;
+    vec->total = width * height;
+    vec->accu = accu;
+    vec->val = malloc(vec->total * sizeof(ArbNum));
+    //Every member gets two slots, one for each component
+    int slot = accu + 2;
+    vec->pool = calloc((size_t)vec->total * 2 * slot, sizeof(uint32_t));
+    if(vec->val == NULL || vec->pool == NULL) error(mallocError);
+    for(int i = 0;i < vec->total;i++) {
+        vec->val[i].r = arbCTR(vec->pool + (size_t)i * 2 * slot, 1, 0, 0, accu);
+        vec->val[i].i = arbCTR(vec->pool + ((size_t)i * 2 + 1) * slot, 1, 0, 0, accu);
+        vec->val[i].u = 0;
+    }
+    out.vecArb = vec;
+    return out;
+}
+Value arbVecFromValue(Value val) {
+    if(val.type == value_arbvec) return copyValue(val);
+    if(val.type == value_arb) {
+        Value out = newValArbVec(1, 1, globalAccuracy);
+        ArbNum* num = out.vecArb->val;
+        arb_set_into(&num->r, val.numArb->r);
+        arb_set_into(&num->i, val.numArb->i);
+        num->u = val.numArb->u;
+        return out;
+    }
+    if(val.type != value_num && val.type != value_vec) {
+        error("cannot convert to an arbitrary-precision vector");
+        return NULLVAL;
+    }
+    Vector vec = val.type == value_vec ? val.vec : newVecScalar(val.num);
+    Value out = newValArbVec(vec.width, vec.height, globalAccuracy);
+    for(int i = 0;i < vec.total;i++) {
+        ArbNum* num = out.vecArb->val + i;
+        Arb r = doubleToArb(vec.val[i].r, globalAccuracy);
+        Arb im = doubleToArb(vec.val[i].i, globalAccuracy);
+        arb_set_into(&num->r, r);
+        arb_set_into(&num->i, im);
+        num->u = vec.val[i].u;
+        freeArb(r);
+        freeArb(im);
+    }
+    if(val.type == value_num) free(vec.val);
+    return out;
+}
 Value copyValue(Value val) {
     Value out;
     out.type = val.type;
-    if(val.type == value_num) out.num = val.num;
+    if(val.type == value_num || val.type == value_dd) out.num = val.num;
     if(val.type == value_vec) {
         out.vec = newVec(val.vec.width, val.vec.height);
         int i;
@@ -305,16 +401,31 @@ Value copyValue(Value val) {
         *out.code = copyCodeBlock(*val.code, NULL, 0, false);
         out.argNames = argListCopy(val.argNames);
     }
-    if(val.type == value_arb) {
+    if(val.type == value_arb || val.type == value_dec) {
         if(val.numArb != NULL) {
             out.numArb = malloc(sizeof(ArbNum));
             *out.numArb = *val.numArb;
-            out.numArb->r.mantissa = malloc(val.numArb->r.len);
-            memcpy(out.numArb->r.mantissa, val.numArb->r.mantissa, val.numArb->r.len);
-            out.numArb->i.mantissa = malloc(val.numArb->i.len);
-            memcpy(out.numArb->i.mantissa, val.numArb->i.mantissa, val.numArb->i.len);
+            out.numArb->r = copyArb(val.numArb->r);
+            out.numArb->i = copyArb(val.numArb->i);
         }
     }
+    if(val.type == value_arbvec) {
+        ArbVec* vec = val.vecArb;
+        out = newValArbVec(vec->width, vec->height, vec->accu);
+        memcpy(out.vecArb->pool, vec->pool, (size_t)vec->total * 2 * (vec->accu + 2) * sizeof(uint32_t));
+        //Rows may have been swapped, so each member keeps its own offset into the pool
+        for(int i = 0;i < vec->total;i++) {
+            ArbNum num = vec->val[i];
+            num.r.mantissa = out.vecArb->pool + (vec->val[i].r.mantissa - vec->pool);
+            num.i.mantissa = out.vecArb->pool + (vec->val[i].i.mantissa - vec->pool);
+            out.vecArb->val[i] = num;
+        }
+    }
+    if(val.type == value_ball) {
+        out.numBall = malloc(sizeof(BallNum));
+        *out.numBall = *val.numBall;
+        out.numBall->b = copyBall(val.numBall->b);
+    }
     if(val.type == value_string) {
         out.string = calloc(strlen(val.string) + 1, 1);
         strcpy(out.string, val.string);
@@ -334,6 +445,10 @@ double getR(Value val) {
         if(val.numArb == NULL) return 0;
         return arbToDouble(val.numArb->r);
     }
+    if(val.type == value_arbvec) return arbToDouble(val.vecArb->val[0].r);
+    if(val.type == value_ball) return arbToDouble(val.numBall->b.mid);
+    if(val.type == value_dd) return val.dd.hi;
+    if(val.type == value_dec) return decToDouble(val.numArb->r);
     return 0;
 }
 Number getNum(Value val) {
@@ -343,6 +458,13 @@ Number getNum(Value val) {
         if(val.numArb == NULL) return NULLNUM;
         return newNum(arbToDouble(val.numArb->r), arbToDouble(val.numArb->i), val.numArb->u);
     }
+    if(val.type == value_arbvec) {
+        ArbNum num = val.vecArb->val[0];
+        return newNum(arbToDouble(num.r), arbToDouble(num.i), num.u);
+    }
+    if(val.type == value_ball) return newNum(arbToDouble(val.numBall->b.mid), 0, val.numBall->u);
+    if(val.type == value_dd) return newNum(val.dd.hi, 0, val.u);
+    if(val.type == value_dec) return newNum(decToDouble(val.numArb->r), 0, val.numArb->u);
     return NULLNUM;
 }
 void freeValue(Value val) {
@@ -352,13 +474,22 @@ void freeValue(Value val) {
         freeCodeBlock(*val.code);
         free(val.code);
     }
-    if(val.type == value_arb) {
+    if(val.type == value_arb || val.type == value_dec) {
         if(val.numArb != NULL) {
             free(val.numArb->r.mantissa);
             free(val.numArb->i.mantissa);
         }
         free(val.numArb);
     }
+    if(val.type == value_arbvec) {
+        free(val.vecArb->pool);
+        free(val.vecArb->val);
+        free(val.vecArb);
+    }
+    if(val.type == value_ball) {
+        free(val.numBall->b.mid.mantissa);
+        free(val.numBall);
+    }
     if(val.type == value_string) {
         free(val.string);
     }
@@ -370,6 +501,29 @@ Tree newOp(Tree* branches, int argCount, int opID, int optype) {
     out.argCount = argCount;
     out.op = opID;
     out.optype = optype;
+    out.checkedArgs = getCheckedArgs(out);
+    return out;
+}
+unsigned short getCheckedArgs(Tree tree) {
+    if(tree.optype != optype_builtin || tree.op == op_val || tree.branch == NULL) return 0;
+    const unsigned short allTypes = (2 << (value_dec + 1)) - 2;
+    unsigned short out = 0;
+    for(int i = 0;i < tree.argCount && i < 16;i++) {
+        unsigned short accepted = i < 5 ? stdfunctions[tree.op].inputs[i] : 0;
+        //Functions that take any type
+        if((accepted & allTypes) == allTypes) {
+            out |= 1 << i;
+            continue;
+        }
+        //Constants of an accepted type
+        Tree branch = tree.branch[i];
+        if(branch.optype != optype_builtin || branch.op != op_val) continue;
+        int type = branch.value.type;
+        if(type < 0 || type > value_dec) continue;
+        if(accepted & (2 << type)) out |= 1 << i;
+        //Vector cells and run arguments are not type checked, but double-doubles and decimals still become Arbs
+        else if((tree.op == op_vector || (tree.op == op_run && i != 0)) && type != value_dd && type != value_dec) out |= 1 << i;
+    }
     return out;
 }
 Tree newOpValue(Value value) {
@@ -465,6 +619,8 @@ Tree copyTree(Tree tree, const Tree* replaceArgs, int replaceCount, bool unfold)
         Tree* branch = out.branch + i;
         *branch = copyTree(tree.branch[i], replaceArgs, replaceCount, unfold);
     }
+    //Replaced arguments may change which argument types are known
+    out.checkedArgs = getCheckedArgs(out);
     //Return
     return out;
 }
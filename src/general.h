@@ -2,6 +2,7 @@
 #ifndef GENERAL_H
 #define GENERAL_H 1
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
@@ -19,6 +20,13 @@ typedef struct NumberStruct {
     double i;
     unit_t u;
 } Number;
+/**
+ * Double-double number, the unevaluated sum hi+lo with |lo| at most half an ulp of hi
+ */
+typedef struct DoubleDoubleStruct {
+    double hi;
+    double lo;
+} DD;
 /**
  * A vector (2D array of Number)
  * total is the total number of elements
@@ -37,17 +45,17 @@ typedef struct VectorStruct {
 } Vector;
 /**
  * Arbitrary Precision Number
- * @param mantissa Stores the base-256 digits of the number
+ * @param mantissa Stores the base-2^32 digits (limbs) of the number
  * @param accu Maximum of length
  * @param len Length of the mantissa
- * @param exp Exponent, 0 for integers, 1 for the value 256, -1 for 1/10 ...
+ * @param exp Exponent, 0 for integers, 1 for the value 2^32, -1 for 2^-32 ..., limited to ARB_MAX_EXP
  * @param sign 0 for positive numbers, 1 for negative
  */
 typedef struct ArbStruct {
-    unsigned char* mantissa;
-    short accu;
-    short len;
-    short exp;
+    uint32_t* mantissa;
+    int accu;
+    int len;
+    int exp;
     char sign;
 } Arb;
 /**
@@ -58,6 +66,36 @@ typedef struct ArbNumber {
     Arb i;
     unit_t u;
 } ArbNum;
+/**
+ * Ball of real numbers, which contains every value within the radius of mid
+ * @param mid Midpoint
+ * @param rad Base 2 logarithm of the radius rounded up, -INFINITY when mid is exact
+ */
+typedef struct BallStruct {
+    Arb mid;
+    double rad;
+} Ball;
+/**
+ * Ball with a unit, see ArbNum
+ */
+typedef struct BallNumber {
+    Ball b;
+    unit_t u;
+} BallNum;
+/**
+ * A vector of ArbNum, with every mantissa stored in one contiguous pool
+ * Each component has room for accu+2 digits, so members are written with the _into functions
+ * The members of val point into pool, and are never freed on their own
+ */
+typedef struct ArbVectorStruct {
+    ArbNum* val;
+    uint32_t* pool;
+    //Accuracy of every member
+    int accu;
+    short width;
+    short height;
+    short total;
+} ArbVec;
 struct TreeStruct;
 /**
  * Value that can contain a number or any other type
@@ -76,12 +114,16 @@ typedef struct ValueStruct {
             double i;
             unit_t u;
         };
+        //Overlaps r and i, the unit is u
+        DD dd;
         Vector vec;
         struct {
             struct CodeBlock* code;
             char** argNames;
         };
         ArbNum* numArb;
+        ArbVec* vecArb;
+        BallNum* numBall;
         char* string;
     };
 } Value;
@@ -107,6 +149,7 @@ typedef struct CodeBlock CodeBlock;
  * @param code CodeBlock for optype==optype_anon
  * @param argCount Number of arguments, if op!=0
  * @param argWidth Width of argument vector (internal, only for vector constructor)
+ * @param checkedArgs Bitmask of builtin arguments whose type is already known to be accepted, set by getCheckedArgs
  */
 typedef struct TreeStruct {
     int op;
@@ -121,6 +164,8 @@ typedef struct TreeStruct {
             short argCount;
             //Only for op_vector
             short argWidth;
+            //Only for optype_builtin
+            unsigned short checkedArgs;
             //Only for optype_anon
             char** argNames;
         };
@@ -194,7 +239,7 @@ typedef struct Function {
 struct stdFunction {
     const int nameLen;
     const char* name;
-    const unsigned char inputs[5];
+    const unsigned short inputs[5];
 };
 /**
  * Stores information about an optionally included function
@@ -450,6 +495,30 @@ Vector newVec(short width, short height);
  * Create a numeral value from r, i, and u
  */
 Value newValNum(double r, double i, unit_t u);
+/**
+ * Create an arbitrary-precision value from r and u, with no imaginary component
+ */
+Value newValArb(Arb r, unit_t u);
+/**
+ * Create a double-double value from dd and u
+ */
+Value newValDD(DD dd, unit_t u);
+/**
+ * Create a decimal value from the decimal Arb r and u
+ */
+Value newValDec(Arb r, unit_t u);
+/**
+ * Create a ball value from b and u
+ */
+Value newValBall(Ball b, unit_t u);
+/**
+ * Create an arbitrary-precision vector of zeroes, with accu digits in each component
+ */
+Value newValArbVec(int width, int height, int accu);
+/**
+ * Converts a number, vector or arbitrary-precision number to an arbitrary-precision vector, which must be freed
+ */
+Value arbVecFromValue(Value val);
 /**
  * Frees any array buffers stored in a value (vectors)
  */
@@ -499,6 +568,12 @@ Tree copyTree(Tree tree, const Tree* replaceArgs, int replaceCount, bool unfold)
  * @param op OperatorID
  */
 Tree newOp(Tree* args, int argCount, int op, int optype);
+/**
+ * Returns the checkedArgs bitmask of a builtin operation
+ * Bit i is set when argument i is always accepted by stdfunctions[op].inputs, so computeTreeMicro can skip its type check
+ * @param tree Operation, with its branches already set
+ */
+unsigned short getCheckedArgs(Tree tree);
 /**
  * Returns a new operation with id 0 and value val
  */
@@ -566,7 +641,11 @@ typedef enum ValueType {
     value_vec = 1,
     value_func = 2,
     value_arb = 3,
-    value_string = 4
+    value_string = 4,
+    value_arbvec = 5,
+    value_ball = 6,
+    value_dd = 7,
+    value_dec = 8
 } ValueType;
 typedef enum OpType {
     optype_builtin = 0,
@@ -611,6 +690,9 @@ typedef enum Op {
     op_logten = 36,
     op_log = 37,
     op_fact = 38,
+    op_isprime = 39,
+    op_gcd = 40,
+    op_modpow = 41,
     op_sgn = 43,
     op_abs = 44,
     op_arg = 45,
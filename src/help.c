@@ -237,7 +237,10 @@ const struct HelpPage pages[helpPageCount] = {
     {"Unit convert","-unit", page_command,NULL,"Return the second argument converted to the first input.<br>Syntax:<br>-unit{dest} {exp}.<br><br>Examples:<br><ul><li><syntax>-unit[psi] [atm]</syntax> = <syntax>14.69... [psi]</syntax></li><li><syntax>-unit[mi/s] [c]</syntax> = <syntax>186282.397... [mi/s]</syntax></li></ul>For the first argument, the square brackets are not required, but it looks messy."},
     {"Graph","-g", page_command,NULL,"<syntax>-g</syntax> is in experimental mode, do not use it"},
     {"Parse","-parse", page_command,NULL,"<syntax>-ratio</syntax> command appends a number or vector to history and prints it as a ratio. It uses continued fractions to estimate a ratio. If the contnued fraction does not terminate before 20 digits, it will print the number as a decimal. If the numerator is greated than the denominator, it will print it as a mixed number."},
-    {"Factorize","-factor",page_command,"-factors,prime","The <syntax>-factors</syntax> command (also known as <syntax>-factor</syntax>) reports the prime factors of a number. The command will only run for 32-bit integers, meaning numbers greater than 2 000 000 000 are not supported. The command will either report that the number is prime, or the list of factors that make it. <br>Examples:<ul><li><syntax>-factors 1504</syntax> = <syntax>2^5 * 47</syntax></li></ul>"},
+    {"Factorize","-factor",page_command,"-factors,prime","The <syntax>-factors</syntax> command (also known as <syntax>-factor</syntax>) reports the prime factors of a number. The command will either report that the number is prime, or the list of factors that make it. Numbers past 32 bits are factored with trial division and Pollard's rho, which finds factors of up to about 12 digits. Larger numbers need <help>-setaccu</help> to cover every digit, and cofactors that could not be split are marked as composite. <br>Examples:<ul><li><syntax>-factors 1504</syntax> = <syntax>2^5 * 47</syntax></li></ul>"},
+    {"Export","-export",page_command,"file,write,digits","The <syntax>-export</syntax> command evaluates an expression, appends it to history, and writes the result to a file. The syntax is <syntax>-export filename expression</syntax>. When <syntax>-setaccu</syntax> is set, the digits are converted and written in blocks, so results with millions of digits never need to be held as one string. Trailing zeros are left out, the same as printed results. <br>Examples:<ul><li><syntax>-export pi.txt pi</syntax></li></ul>"},
+    {"Threads","-threads",page_command,"thread,core,benchmark,parallel","The <syntax>-threads</syntax> command sets the number of threads used in accurate mode. Products and conversions of numbers with more than about 15000 digits are split over the threads. <syntax>-threads 0</syntax> uses one thread per core, which is the default, and <syntax>-threads</syntax> on its own shows the current setting. <syntax>-threads bench</syntax> times a product and a conversion to decimal with one thread, each power of two, and the current number of threads, the number of digits can be given after it (200000 by default). <br>Examples:<ul><li><syntax>-threads 4</syntax></li><li><syntax>-threads bench 1000000</syntax></li></ul>"},
+    {"Decimal mode","-setdecimal",page_command,"decimal,base 10,digits,exact","<syntax>-setdecimal on</syntax> stores numbers written in base 10 with decimal digits while <help>-setaccu</help> is set, and <syntax>-setdecimal off</syntax> goes back to binary. Decimal numbers are read and printed in linear time, which is much faster for numbers with many digits, and sums and products of them are exact while they fit in the accuracy, so <syntax>0.1+0.2</syntax> is exactly <syntax>0.3</syntax>. Addition, subtraction, negation and multiplication keep decimal numbers, other functions convert them to binary first. Ball arithmetic takes priority over decimal mode."},
     {"Help","-help", page_command,"search,f1","<strong>-help {name}</strong> opens the help page that most closely resembles name. If no name is provided, the main help menu is opened."},
     #pragma endregion
     #pragma region Builtin Functions
@@ -279,6 +282,9 @@ const struct HelpPage pages[helpPageCount] = {
     {"Logarithm 10","logten(x)",page_function,NULL,"<strong>logten(x)</strong> returns the log—base 10 of x, It is equivalent to <em>log(x,10)</em>"},
     {"Logarithm","log(x,b)",page_function,NULL,"<strong>log(x,b)</strong> returns the log of <em>x</em>, base b. It is equivalent to <em>ln(x)/ln(b)</em>."},
     {"Factorial","fact(x)",page_function,NULL,"<strong>fact(x)</strong> returns the factorial of <em>x</em>. The notation <em>x!</em> is not supported. The factorial of negative integers is not defined."},
+    {"Is prime","isprime(x)",page_function,"prime,primality","<strong>isprime(x)</strong> returns 1 if the integer <em>x</em> is prime and 0 otherwise. It uses the Miller-Rabin test, which is exact below 3.3*10^24. Larger integers need <help>-setaccu</help> to cover every digit."},
+    {"Greatest common divisor","gcd(a,b)",page_function,"gcd,divisor","<strong>gcd(a,b)</strong> returns the greatest common divisor of the integers <em>a</em> and <em>b</em>."},
+    {"Modular power","modpow(b,e,m)",page_function,"modulo,power","<strong>modpow(b,e,m)</strong> returns <em>b^e mod m</em> for integers, without computing <em>b^e</em>. The power must not be negative, and the result is never negative."},
     {"Sign","sgn(x)",page_function,"step","<strong>sgn(x)</strong> returns the sign of <em>x</em>. More specifically, <em>sgn(x)</em> is equivalent to <em>x/abs(x)</em>."},
     {"Absolute value","abs(x)",page_function,NULL,"<strong>abs(x)</strong> returns the absolute value of <em>x</em>. This is defined as the distance of the value from zero. Vectors and complex numbers are accepted."},
     {"Argument","arg(z)",page_function,"angle,imaginary","<syntax>arg(z)</syntax> returns the argument of <syntax>z</syntax>. The argument of a complex number is the angle from the positive real axis.<br><h3>Examples:</h3><br><syntax>arg(1) = 0</syntax><br><syntax>arg(i) = pi/2</syntax><br><syntax>arg(-2) = pi</syntax>"},
@@ -395,6 +395,7 @@ Tree derivative(Tree tree) {
             for(i = 0;i < tree.argCount;i++) {
                 out.branch[i] = derivative(tree.branch[i]);
             }
+            out.checkedArgs = getCheckedArgs(out);
             return out;
         }
     }
@@ -318,7 +318,14 @@ Tree generateTree(const char* eq, char** argNames, char** localVars, double base
                 if(base == 'x') baseToUse = 16;
                 numString = section + 2;
             }
-            if(useArb) {
+            if(useArb && useBall) ops[i] = newOpValue(newValBall(parseBall(numString, baseToUse, globalAccuracy), 0));
+            else if(useDD) {
+                Arb num = parseArb(numString, baseToUse, 5);
+                ops[i] = newOpValue(newValDD(arbToDD(num), 0));
+                freeArb(num);
+            }
+            else if(useArb && useDec && baseToUse == 10) ops[i] = newOpValue(newValDec(parseDec(numString, getDecAccuracy()), 0));
+            else if(useArb) {
                 Arb num = parseArb(numString, baseToUse, globalAccuracy);
                 Value out;
                 out.type = value_arb;
@@ -373,7 +380,8 @@ Tree generateTree(const char* eq, char** argNames, char** localVars, double base
             //Check for wrong number of arguments
             int argCount = commaCount + 1;
             if(op.optype == 0) {
-                int builtinArgCount = strlen(stdfunctions[op.op].inputs);
+                int builtinArgCount = 0;
+                while(stdfunctions[op.op].inputs[builtinArgCount] != 0) builtinArgCount++;
                 if(builtinArgCount < argCount && op.op != op_run) {
                     error("too many arguments for '%s'", section);
                     goto error;
@@ -522,6 +530,7 @@ Tree generateTree(const char* eq, char** argNames, char** localVars, double base
             ops[i].branch = cells;
             ops[i].argCount = width * height;
             ops[i].argWidth = width;
+            ops[i].checkedArgs = getCheckedArgs(ops[i]);
         }
         if(type == sec_anonymousFunction) {
             char** argList = parseArgumentList(section);
@@ -157,6 +157,29 @@ char* valueToString(Value val, double base) {
         strcat(out, ">");
         return out;
     }
+    if(val.type == value_arbvec) {
+        ArbVec* vec = val.vecArb;
+        char* values[vec->total];
+        int len = 3;
+        for(int i = 0;i < vec->total;i++) {
+            Value cell;
+            cell.type = value_arb;
+            cell.numArb = vec->val + i;
+            values[i] = valueToString(cell, base);
+            len += 1 + strlen(values[i]);
+        }
+        char* out = calloc(len, sizeof(char));
+        if(out == NULL) { error(mallocError);return NULL; }
+        strcat(out, "<");
+        for(int j = 0;j < vec->height;j++) for(int i = 0;i < vec->width;i++) {
+            if(i != 0) strcat(out, ",");
+            else if(j != 0) strcat(out, ";");
+            strcat(out, values[i + j * vec->width]);
+            free(values[i + j * vec->width]);
+        }
+        strcat(out, ">");
+        return out;
+    }
     if(val.type == value_func) {
         Tree outTree;
         outTree.code = val.code;
@@ -166,6 +189,42 @@ char* valueToString(Value val, double base) {
         outTree.op = 0;
         return treeToString(outTree, false, NULL, globalLocalVariables);
     }
+    if(val.type == value_ball || val.type == value_dd || val.type == value_dec) {
+        char* numString;
+        unit_t unit;
+        if(val.type == value_ball) {
+            numString = ballToString(val.numBall->b, base, getArbDigitCount((int)base));
+            unit = val.numBall->u;
+        }
+        else if(val.type == value_dec) {
+            //Decimal values are printed directly in base 10, other bases go through a binary Arb
+            if(base == 10) numString = decToString(val.numArb->r, getArbDigitCount(10));
+            else {
+                Arb arb = decToArb(val.numArb->r, globalAccuracy);
+                numString = arbToString(arb, base, getArbDigitCount((int)base));
+                freeArb(arb);
+            }
+            unit = val.numArb->u;
+        }
+        else {
+            //Double-doubles have 106 bits
+            int digitCount = getArbDigitCount((int)base);
+            int maxDigits = 106 * log(2) / log(base);
+            if(digitCount <= 0 || digitCount > maxDigits) digitCount = maxDigits;
+            Arb arb = ddToArb(val.dd, 5);
+            numString = arbToString(arb, base, digitCount);
+            freeArb(arb);
+            unit = val.u;
+        }
+        if(unit == 0) return numString;
+        char* u = toStringUnit(unit);
+        int length = strlen(numString) + strlen(u) + 3;
+        char* out = calloc(length, 1);
+        snprintf(out, length, "%s[%s]", numString, u);
+        free(numString);
+        free(u);
+        return out;
+    }
     if(val.type == value_arb) {
         char* out;
         if(val.numArb == NULL) {
@@ -190,7 +249,7 @@ char* valueToString(Value val, double base) {
             u = toStringUnit(val.numArb->u);
             length += 3 + strlen(u);
         }
-        out = calloc(length, 1);
+        out = calloc(length + 1, 1);
         if(r != NULL && strcmp("0", r) != 0) {
             strcat(out, r);
             if(i != NULL && strcmp("0", i) != 0) {
@@ -214,6 +273,7 @@ char* valueToString(Value val, double base) {
             strcat(out, u);
             strcat(out, "]");
         }
+        if(out[0] == '\0') strcpy(out, "0");
         if(r != NULL) free(r);
         if(i != NULL) free(i);
         if(u != NULL) free(u);
@@ -145,7 +145,8 @@ char* randomExpression(int nest, char** args, char** localvars, int base, bool u
     if(type == 1) {
         //Variable
         int id = sortedBuiltin[rand() % sortedBuiltinLen];
-        int argCount = strlen(stdfunctions[id].inputs);
+        int argCount = 0;
+        while(stdfunctions[id].inputs[argCount] != 0) argCount++;
         if(argCount == 0) {
             char* out = calloc(stdfunctions[id].nameLen + 1, 1);
             memcpy(out, stdfunctions[id].name, stdfunctions[id].nameLen);
@@ -645,6 +646,242 @@ void test_includableFunctions() {
     }
     totalNumberOfTests += count;
 }
+void test_arb() {
+    //(10^n-1)^2 = 99...9800...01, the sizes are chosen to hit each multiplication algorithm
+    //The second pass splits the products and conversions over threads, with the NTT used earlier
+    //Each square is also done with decimal digits
+    const int sizes[] = { 10, 150, 600, 2000, 4000 };
+    int oldThreads = arbThreadCount, oldThreshold = arbParallelThreshold, oldNTT = nttThreshold, oldDecNTT = decNTTThreshold;
+    for(int pass = 0;pass < 2;pass++) for(int i = 0;i < sizeof(sizes) / sizeof(int);i++) {
+        if(pass == 1 && i == 0) {
+            arbSetThreadCount(4);
+            arbParallelThreshold = 16;
+            nttThreshold = 300;
+            decNTTThreshold = 100;
+        }
+        int n = sizes[i];
+        int accu = (2 * n + 10) * log(10) / log(4294967296.0);
+        char nines[n + 1];
+        memset(nines, '9', n);
+        nines[n] = 0;
+        char expected[2 * n + 1];
+        memset(expected, '9', n - 1);
+        expected[n - 1] = '8';
+        memset(expected + n, '0', n - 1);
+        expected[2 * n - 1] = '1';
+        expected[2 * n] = 0;
+        Arb one = parseArb(nines, 10, accu);
+        Arb square = arb_mult(one, one);
+        char* out = arbToString(square, 10, 2 * n + 5);
+        if(strcmp(out, expected) != 0) failedTest(i, nines, "square of 10^%d-1 was incorrect with %d threads", n, arbActiveThreads());
+        free(out);
+        freeArb(one);
+        freeArb(square);
+        one = parseDec(nines, 2 * n / 9 + 2);
+        square = dec_mult(one, one);
+        out = decToString(square, 2 * n + 5);
+        if(strcmp(out, expected) != 0) failedTest(i, nines, "decimal square of 10^%d-1 was incorrect with %d threads", n, arbActiveThreads());
+        free(out);
+        freeArb(one);
+        freeArb(square);
+    }
+    arbSetThreadCount(oldThreads);
+    arbParallelThreshold = oldThreshold;
+    nttThreshold = oldNTT;
+    decNTTThreshold = oldDecNTT;
+    totalNumberOfTests += 4 * sizeof(sizes) / sizeof(int);
+    //Expressions in accurate mode, compared to the first 35 digits
+    const char* arbTests[][2] = {
+        {"exp(1)","2.7182818284590452353602874713526624"},
+        {"ln(2)","0.6931471805599453094172321214581765"},
+        {"2^0.5","1.4142135623730950488016887242096980"},
+        {"sinh(-1)","-1.1752011936438014568823818505956008"},
+        {"exp(-1)","0.36787944117144232159552377016146086"},
+        {"(-2)^3","-8"},
+        {"pi","3.1415926535897932384626433832795028"},
+        {"phi","1.6180339887498948482045868343656381"},
+        {"pi*e","8.5397342226735670654635508695465744"},
+        {"logten(2)","0.30102999566398119521373889472449302"},
+        {"1/7","0.14285714285714285714285714285714285"},
+        {"cbrt(2)","1.2599210498948731647672106072782283"},
+        {"sqrt(-4)","2i"},
+        {"exp(100)","26881171418161354484126255515800135873611118.773741922415191"},
+        {"123.456e2","12345.6"},
+        {"1e-30","1e-30"},
+        {"1e300000000*1e-299999990","10000000000"},
+        {"1e-999999999","0"},
+        {"(2+3i)*(4-5i)","23 + 2i"},
+        {"(2+3i)/(4-5i)","-0.170731707317073170731707317073170731707317073170731707317073 + 0.536585365853658536585365853658536585365853658536585365853659i"},
+        {"(1+i)^-3","-0.25 - 0.25i"},
+        {"(-3-4i)^0.5","1 - 2i"},
+        {"det(<1,2;3,4>)","-2"},
+        {"mat_inv(<1,2;3,4>)","<-2,1;1.5,-0.5>"},
+        {"mat_mult(<1,2;3,4>,<5;6>)","<17;39>"},
+        {"<1,2>+<3,4,5>/2","<2.5,4,2.5>"},
+        {"sin(1)","0.841470984807896506652502321630298999622563060798371"},
+        {"cos(100)","0.862318872287683934101938513950842535510084008535510"},
+        {"atan(1)*4","3.14159265358979323846264338327950288419716939937510"},
+        {"asin(-0.5)","-0.523598775598298873077107230546583814032861566562517"},
+        {"fact(30)","265252859812191058636308480000000"},
+        {"fact(0)+0.5","1.5"},
+        {"fact(1)+0.5","1.5"},
+        {"fact(5-5)*7","7"},
+        {"fact(-0.5)","1.77245385090551602729816748334114518279754945612238"},
+        {"fact(-3.5)","-0.945308720482941881225689324448610764158693043265"},
+        {"fact(1000000)","8.263931688331240062376646103172666291135347978963"},
+        {"isprime(2^127-1)","1"},
+        {"gcd(2^100*3^7,6^60)","2521439330575174336512"},
+        {"modpow(2,10^30,10^40+7)","9876351759253779499038390711716799184558"},
+    };
+    useArb = true;
+    digitAccuracy = 60;
+    globalAccuracy = 65 * log(10) / log(4294967296.0) + 1;
+    for(int i = 0;i < sizeof(arbTests) / sizeof(arbTests[0]);i++) {
+        currentTest = arbTests[i][0];
+        Value out = calculate(arbTests[i][0], 0);
+        char* str = valueToString(out, 10);
+        if(globalError || strncmp(str, arbTests[i][1], strlen(arbTests[i][1])) != 0) {
+            failedTest(i, arbTests[i][0], "expected %s, got %s", arbTests[i][1], str);
+            globalError = false;
+        }
+        free(str);
+        freeValue(out);
+    }
+    //Every digit printed by -setaccu has to be correct, including the last one
+    const char* lastDigitTests[][2] = {
+        {"pi","3.141592653589793238462643383279502884197169399375105820974944592307816406286208998628034825342117068"},
+        {"sqrt(2)","1.414213562373095048801688724209698078569671875376948073176679737990732478462107038850387534327641573"},
+        {"exp(1)","2.718281828459045235360287471352662497757247093699959574966967627724076630353547594571382178525166427"},
+        {"3.14159265358979323846264338327950288419716939937510582097494459230781640628620899862803482534211706798214808651","3.141592653589793238462643383279502884197169399375105820974944592307816406286208998628034825342117068"},
+    };
+    int oldAccuracy = globalAccuracy;
+    char command[] = "-setaccu 100";
+    free(runCommand(command));
+    for(int i = 0;i < sizeof(lastDigitTests) / sizeof(lastDigitTests[0]);i++) {
+        currentTest = lastDigitTests[i][0];
+        Value out = calculate(lastDigitTests[i][0], 0);
+        char* str = valueToString(out, 10);
+        if(globalError || strcmp(str, lastDigitTests[i][1]) != 0) {
+            failedTest(i, lastDigitTests[i][0], "expected %s, got %s at 100 digits", lastDigitTests[i][1], str);
+            globalError = false;
+        }
+        free(str);
+        freeValue(out);
+    }
+    globalAccuracy = oldAccuracy;
+    digitAccuracy = 60;
+    //Balls only print the digits that are guaranteed by the radius
+    const char* ballTests[][2] = {
+        {"2^100+1","1267650600228229401496703205377"},
+        {"(1+1e-10)^(1e10)","2.718281828323131143949794001297229499885179934"},
+        {"exp(pi*sqrt(163))","262537412640768743.99999999999925007259719818568887935386"},
+        {"exp(1)-e","0 +/- 8e-58"},
+    };
+    useBall = true;
+    for(int i = 0;i < sizeof(ballTests) / sizeof(ballTests[0]);i++) {
+        currentTest = ballTests[i][0];
+        Value out = calculate(ballTests[i][0], 0);
+        char* str = valueToString(out, 10);
+        if(globalError || strcmp(str, ballTests[i][1]) != 0) {
+            failedTest(i, ballTests[i][0], "expected %s, got %s", ballTests[i][1], str);
+            globalError = false;
+        }
+        free(str);
+        freeValue(out);
+    }
+    useBall = false;
+    //Decimal values are exact for sums and products of decimal literals, anything else becomes an Arb
+    const char* decTests[][2] = {
+        {"0.1+0.2","0.3"},
+        {"0.1*3-0.3","0"},
+        {"123456789.123456789*987654321.987654321","121932631356500531.347203169112635269"},
+        {"-5.5+2e-20","-5.49999999999999999998"},
+        {"0.9999999999999999999999999999999999999999999999999999999999999999999999*2","2"},
+        {"-0.0000123456*1","-0.0000123456"},
+        {"1.5*sqrt(4)","3"},
+    };
+    useDec = true;
+    for(int i = 0;i < sizeof(decTests) / sizeof(decTests[0]);i++) {
+        currentTest = decTests[i][0];
+        Value out = calculate(decTests[i][0], 0);
+        char* str = valueToString(out, 10);
+        if(globalError || strcmp(str, decTests[i][1]) != 0 || (i < 6 && out.type != value_dec)) {
+            failedTest(i, decTests[i][0], "expected %s, got %s", decTests[i][1], str);
+            globalError = false;
+        }
+        //-export streams decimal values, which has to match the printed string
+        if(out.type == value_dec) {
+            FILE* file = tmpfile();
+            decWriteDigits(out.numArb->r, getArbDigitCount(10), file);
+            char written[200] = { 0 };
+            rewind(file);
+            fread(written, 1, sizeof(written) - 1, file);
+            fclose(file);
+            if(strcmp(written, str) != 0) failedTest(i, decTests[i][0], "expected %s to be written, got %s", str, written);
+        }
+        free(str);
+        freeValue(out);
+    }
+    useDec = false;
+    useArb = false;
+    //Double-doubles are only checked to 28 digits
+    const char* ddTests[][2] = {
+        {"exp(1)","2.718281828459045235360287471"},
+        {"sqrt(2)/3","0.4714045207910316829338962414"},
+        {"sin(1)+ln(10)","3.144056077801942190670493776"},
+        {"atan(1)*4","3.141592653589793238462643383"},
+        {"sqrt(-4)","2i"},
+    };
+    useDD = true;
+    for(int i = 0;i < sizeof(ddTests) / sizeof(ddTests[0]);i++) {
+        currentTest = ddTests[i][0];
+        Value out = calculate(ddTests[i][0], 0);
+        char* str = valueToString(out, 10);
+        if(globalError || strncmp(str, ddTests[i][1], strlen(ddTests[i][1])) != 0) {
+            failedTest(i, ddTests[i][0], "expected %s, got %s", ddTests[i][1], str);
+            globalError = false;
+        }
+        free(str);
+        freeValue(out);
+    }
+    useDD = false;
+    totalNumberOfTests += sizeof(arbTests) / sizeof(arbTests[0]) + sizeof(lastDigitTests) / sizeof(lastDigitTests[0]) + sizeof(ballTests) / sizeof(ballTests[0]) + sizeof(decTests) / sizeof(decTests[0]) + sizeof(ddTests) / sizeof(ddTests[0]);
+    //Pi beyond the hardcoded table
+    const char* piDigits = "3.14159265358979323846264338327950288419716939937510582097494459230781640628620899862803482534211706";
+    Arb pi = arb_pi(40);
+    char* piString = arbToString(pi, 10, 300);
+    if(strncmp(piString, piDigits, strlen(piDigits)) != 0) failedTest(0, "arb_pi(40)", "got %s", piString);
+    free(piString);
+    freeArb(pi);
+    //Lower accuracies are rounded from the cached value
+    pi = arb_pi(20);
+    piString = arbToString(pi, 10, 300);
+    if(pi.accu != 20 || strncmp(piString, piDigits, 60) != 0) failedTest(1, "arb_pi(20)", "got %s", piString);
+    free(piString);
+    freeArb(pi);
+    //Destination versions, with dst also used as an argument
+    Arb a = doubleToArb(1.25, 4), b = doubleToArb(-3.5, 4);
+    Arb dst = arbBuffer(4);
+    arb_set_into(&dst, a);
+    arb_subtract_into(&dst, dst, b);
+    arb_mult_into(&dst, dst, b);
+    arb_add_into(&dst, b, dst);
+    if(arbToDouble(dst) != -20.125) failedTest(2, "arb_into", "expected -20.125, got %f", arbToDouble(dst));
+    freeArb(a);
+    freeArb(b);
+    freeArb(dst);
+    //Computing pi at rising accuracy must not leak, the caches are emptied so every mantissa has to be freed
+    freeArbCaches();
+    long long liveBefore = arbAllocCount - arbFreeCount;
+    for(int accu = 40;accu <= 400;accu *= 10) {
+        pi = arb_pi(accu);
+        freeArb(pi);
+    }
+    freeArbCaches();
+    long long leaked = arbAllocCount - arbFreeCount - liveBefore;
+    if(leaked != 0) failedTest(3, "arb_pi(400)", "leaked %lld mantissas", leaked);
+    totalNumberOfTests += 4;
+}
 void test_singleRandomHighlight() {
     char test[50];
     for(int j = 0;j < 49;j++) test[j] = validChars[rand() % (sizeof(validChars) - 1)];
@@ -733,6 +970,7 @@ const struct Test {
     {&test_highlighting,"highlighting",testtype_constant},
     {&test_help,"help",testtype_constant},
     {&test_includableFunctions,"includable functions",testtype_constant},
+    {&test_arb,"arbitrary precision",testtype_constant},
     {&test_singleRandomExpressionHighlight,"random expression highlighting",testtype_random},
     {&test_singleRandomHighlight,"random highlighting",testtype_random},
     {&test_singleRandomParse,"random parsing",testtype_random},
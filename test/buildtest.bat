@@ -1,2 +1,2 @@
-gcc Test.c -lm -g -o test.exe ../src/arb/c ../src/command.c ../src/compute.c ../src/functions.c ../src/general.c ../src/help.c ../src/highlight.c ../src/misc.c ../src/parser.c ../src/print.c ../src/units.c
+gcc Test.c -lm -pthread -g -o test.exe ../src/arb/c ../src/command.c ../src/compute.c ../src/functions.c ../src/general.c ../src/help.c ../src/highlight.c ../src/misc.c ../src/parser.c ../src/print.c ../src/units.c
 test.exe %1 %2 %3 %4
\ No newline at end of file